@@ -0,0 +1,53 @@
+#!/bin/sh
+# Compares the peak memory of the release build and of the build with compressed neighbor lists (make compressed,
+# see Kernel), each with and without --compact, on generated graphs with 8 million edges. The graphs are kept in
+# $MEMORY_DIR/graphs like those of run_bench.sh, and the peak RSS is taken from the stats of each run.
+# Usually run by `make compressed_memory`. Environment variables:
+#   MEMORY_RELEASE     the release heuristic_solver (default build/release/heuristic_solver)
+#   MEMORY_COMPRESSED  the compressed heuristic_solver (default build/compressed/heuristic_solver)
+#   MEMORY_TIME        the time limit per run in seconds (default 10)
+#   MEMORY_DIR         where the graphs and results are written (default build/bench)
+
+set -e
+
+MEMORY_RELEASE=${MEMORY_RELEASE:-build/release/heuristic_solver}
+MEMORY_COMPRESSED=${MEMORY_COMPRESSED:-build/compressed/heuristic_solver}
+MEMORY_TIME=${MEMORY_TIME:-10}
+MEMORY_DIR=${MEMORY_DIR:-build/bench}
+GENERATOR=$MEMORY_DIR/generate_graph
+SEED=1
+
+# name, generator class, number of vertices, generator seed, generator parameter
+GRAPHS="
+er_1m           er        1000000 1 16
+geometric_1m    geometric 1000000 1 16
+"
+
+# see run_bench.sh
+json_value() { # line_key key file
+    sed -n "/\"$1\"/s/.*\"$2\": \([0-9.]*\).*/\1/p" "$3"
+}
+
+mkdir -p "$MEMORY_DIR/graphs" "$MEMORY_DIR/results"
+printf '%-16s %-12s %-9s %12s %8s %12s %8s\n' graph build options peak_rss_kb parse_s iter_per_s ds_size
+echo "$GRAPHS" | while read -r name graph_class n graph_seed param; do
+    [ -n "$name" ] || continue
+    graph=$MEMORY_DIR/graphs/$name.gr
+    if [ ! -f "$graph" ]; then
+        "$GENERATOR" "$graph_class" "$n" "$graph_seed" "$param" > "$graph.tmp"
+        mv "$graph.tmp" "$graph"
+    fi
+    for build in release compressed; do
+        solver=$MEMORY_RELEASE
+        [ "$build" = release ] || solver=$MEMORY_COMPRESSED
+        for options in "" --compact; do
+            stats=$MEMORY_DIR/results/memory_${name}_${build}${options}.json
+            # shellcheck disable=SC2086 # options is empty or one option
+            "$solver" --seed "$SEED" --time-limit "$MEMORY_TIME" --stats "$stats" $options \
+                < "$graph" > /dev/null 2> /dev/null
+            printf '%-16s %-12s %-9s %12s %8.3f %12.1f %8s\n' "$name" "$build" "${options:--}" \
+                "$(json_value peak_rss_kb peak_rss_kb "$stats")" "$(json_value parse_seconds parse_seconds "$stats")" \
+                "$(json_value search iterations_per_second "$stats")" "$(json_value ds_size ds_size "$stats")"
+        done
+    done
+done
@@ -0,0 +1,141 @@
+// Checks that edge counts of 2^32 and more are neither truncated nor overflow on the paths that see them before the
+// edges themselves: the problem line of graph_parse, the array sizes of kernel_new, and the printed counts of the
+// stats and of the kernel export. The address space is limited, so that arrays for more than 2^32 edges cannot be
+// allocated: a count that is handled as 64 bit makes the allocation fail, a truncated one would make it succeed.
+// The whole solve of such a graph is checked by bench/large_solve.sh. Build and run with `make edge_count_check`.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <float.h>
+#include <sys/resource.h>
+
+#include "graph.h"
+#include "kernel.h"
+#include "scheduler.h"
+#include "solve_stats.h"
+
+
+
+#define ADDRESS_SPACE_LIMIT (1ull << 30) // far below the 64 GiB of the edge array of 2^32 edges
+#define LARGE_M             ((1ull << 32) + 1) // the smallest count that a 32 bit count would truncate (to 1)
+#define OUTPUT_SIZE         4096
+
+
+
+static bool _g_failed = false;
+
+
+
+static void _report(const char* name, bool ok)
+{
+    printf("  %-60s %s\n", name, ok ? "ok" : "FAILED");
+    _g_failed |= !ok;
+}
+
+
+
+// parse text with graph_parse, and check that it fails with errno == expected_errno
+static void _check_parse_fails(const char* name, const char* text, int expected_errno)
+{
+    atomic_bool never_set = false;
+    const StopCondition stop = {.flag = &never_set, .deadline = DBL_MAX};
+    FILE* file = fmemopen((void*)text, strlen(text), "r");
+    if(!file) {
+        perror("edge_count_check: fmemopen failed");
+        exit(EXIT_FAILURE);
+    }
+    fflush(stdout); // before the error messages of the parser
+    errno = 0;
+    Graph* g = graph_parse(file, &stop);
+    const int parse_errno = errno;
+    fclose(file);
+    _report(name, g == NULL && parse_errno == expected_errno);
+    if(g) {
+        graph_free(g);
+    }
+}
+
+
+
+// write with write_output to a memory buffer, and check that the output contains expected
+static void _check_output(const char* name, bool (*write_output)(const void*, FILE*), const void* data,
+                          const char* expected)
+{
+    static char output[OUTPUT_SIZE];
+    memset(output, 0, sizeof(output));
+    FILE* file = fmemopen(output, sizeof(output) - 1, "w");
+    if(!file) {
+        perror("edge_count_check: fmemopen failed");
+        exit(EXIT_FAILURE);
+    }
+    const bool written = write_output(data, file);
+    fclose(file);
+    _report(name, written && strstr(output, expected) != NULL);
+}
+
+
+
+static bool _write_stats(const void* stats, FILE* file)
+{
+    return solve_stats_write_json(stats, file);
+}
+
+
+
+static bool _write_kernel(const void* k, FILE* file)
+{
+    return kernel_export_pace(k, file);
+}
+
+
+
+int main(void)
+{
+    const struct rlimit limit = {.rlim_cur = ADDRESS_SPACE_LIMIT, .rlim_max = ADDRESS_SPACE_LIMIT};
+    if(setrlimit(RLIMIT_AS, &limit) != 0) {
+        perror("edge_count_check: limiting the address space failed");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("graph_parse (the error messages of the parser are expected):\n");
+    // with m truncated to 1 the graph would be valid, and with 1 edge missing it would be EINVAL
+    _check_parse_fails("m = 2^32 + 1 needs more memory than is available", "p ds 3 4294967297\n1 2\n", ENOMEM);
+    _check_parse_fails("m = 2^64 - 1 is too large", "p ds 3 18446744073709551615\n1 2\n", EINVAL);
+    _check_parse_fails("n = 2^32 - 1 is too large", "p ds 4294967295 1\n1 2\n", EINVAL);
+
+    printf("kernel_new:\n");
+    Kernel* large = kernel_new(3, LARGE_M, 0);
+    _report("m = 2^32 + 1 needs more memory than is available", large == NULL);
+    if(large) {
+        kernel_free(large);
+    }
+    Kernel* small = kernel_new(3, 1, 0);
+    _report("m = 1 fits", small != NULL);
+
+    printf("printed edge counts:\n");
+    SolveStats stats;
+    solve_stats_init(&stats);
+    stats.input_m = LARGE_M;
+    stats.kernel_m = LARGE_M;
+    _check_output("solve_stats_write_json input m", _write_stats, &stats, "\"input\": {\"n\": 0, \"m\": 4294967297,");
+    _check_output("solve_stats_write_json kernel m", _write_stats, &stats, "\"kernel\": {\"n\": 0, \"m\": 4294967297,");
+    if(small) {
+        // only the problem line is written for a kernel without vertices, the edges are never read
+        small->n = 0;
+        small->m = LARGE_M;
+        small->offsets[0] = 0;
+        _check_output("kernel_export_pace problem line", _write_kernel, small, "p ds 0 4294967297\n");
+        kernel_free(small);
+    }
+
+    printf("offsets beyond 2^32:\n");
+    // the last vertices of a kernel with more than 2^31 edges, whose neighbors start beyond 2^32
+    const Kernel view = {.offsets = (size_t[]){LARGE_M, LARGE_M + 2, LARGE_M + 5}, .n = 2};
+    _report("kernel_degree", kernel_degree(&view, 0) == 2 && kernel_degree(&view, 1) == 3);
+
+    return _g_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,297 @@
+// Generates the synthetic graphs of the benchmark suite in the PACE format. The same arguments always give
+// the same graph, so the benchmark results of different builds can be compared.
+// Usage: generate_graph CLASS N SEED [PARAM] > graph.gr
+//   er         Erdős–Rényi: random edges, PARAM is the average degree (default 6)
+//   geometric  random geometric graph in the unit square, PARAM is the average degree (default 6)
+//   grid       the grid graph with about N vertices, without PARAM
+//   ba         Barabási–Albert: preferential attachment, PARAM is the number of edges of a new vertex (default 3)
+//   road       road-like: a grid with missing streets and many vertices of degree 2 on the remaining ones,
+//              PARAM is the probability that a street exists (default 0.65)
+// Used by bench/run_bench.sh, see `make bench`.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+
+#include "fast_random.h"
+
+
+
+#define ROAD_SUBDIVISION_PROBABILITY 0.5 // the probability of every further vertex of degree 2 on a street
+
+
+
+typedef struct EdgeList {
+    uint64_t* edges; // (smaller endpoint << 32) | larger endpoint, 1-based
+    size_t count;
+    size_t capacity;
+} EdgeList;
+
+
+
+static void _add_edge(EdgeList* list, uint32_t u, uint32_t v)
+{
+    if(u == v) {
+        return;
+    }
+    if(list->count == list->capacity) {
+        list->capacity = list->capacity == 0 ? 1024 : 2 * list->capacity;
+        list->edges = realloc(list->edges, list->capacity * sizeof(uint64_t));
+        if(!list->edges) {
+            perror("generate_graph: allocating edges failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->edges[list->count++] = u < v ? ((uint64_t)u << 32) | v : ((uint64_t)v << 32) | u;
+}
+
+
+
+static int _compare_edges(const void* a, const void* b)
+{
+    const uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+
+
+// a uniformly random number in [0, bound)
+static uint32_t _random_below(fast_random_t* rng, uint32_t bound)
+{
+    return (uint32_t)(fast_random(rng) % bound);
+}
+
+
+
+// a uniformly random number in [0, 1)
+static double _random_unit(fast_random_t* rng)
+{
+    return (double)(fast_random(rng) >> 11) * 0x1.0p-53;
+}
+
+
+
+static void _generate_er(EdgeList* list, uint32_t n, double average_degree, fast_random_t* rng)
+{
+    const size_t m = (size_t)(average_degree * n / 2.0);
+    for(size_t i = 0; i < m; i++) {
+        _add_edge(list, 1 + _random_below(rng, n), 1 + _random_below(rng, n));
+    }
+}
+
+
+
+// The points are sorted into square cells of the side length of the connection radius, so only the points
+// in the neighboring cells have to be compared.
+static void _generate_geometric(EdgeList* list, uint32_t n, double average_degree, fast_random_t* rng)
+{
+    const double radius = sqrt(average_degree / (M_PI * n));
+    const uint32_t cells_per_side = radius < 1.0 ? (uint32_t)(1.0 / radius) : 1;
+    const size_t cell_count = (size_t)cells_per_side * cells_per_side;
+    double* x = malloc(n * sizeof(double));
+    double* y = malloc(n * sizeof(double));
+    uint32_t* cell_start = calloc(cell_count + 1, sizeof(uint32_t));
+    uint32_t* by_cell = malloc(n * sizeof(uint32_t));
+    uint32_t* cell_of = malloc(n * sizeof(uint32_t));
+    if(!x || !y || !cell_start || !by_cell || !cell_of) {
+        perror("generate_graph: allocating points failed");
+        exit(EXIT_FAILURE);
+    }
+    for(uint32_t v = 0; v < n; v++) {
+        x[v] = _random_unit(rng);
+        y[v] = _random_unit(rng);
+        const uint32_t cx = (uint32_t)(x[v] * cells_per_side), cy = (uint32_t)(y[v] * cells_per_side);
+        cell_of[v] = cy * cells_per_side + cx;
+        cell_start[cell_of[v] + 1]++;
+    }
+    for(size_t c = 0; c < cell_count; c++) {
+        cell_start[c + 1] += cell_start[c];
+    }
+    for(uint32_t v = 0; v < n; v++) { // counting sort, cell_start[c] moves to the end of cell c
+        by_cell[cell_start[cell_of[v]]++] = v;
+    }
+    memmove(cell_start + 1, cell_start, cell_count * sizeof(uint32_t));
+    cell_start[0] = 0;
+    for(uint32_t cy = 0; cy < cells_per_side; cy++) {
+        for(uint32_t cx = 0; cx < cells_per_side; cx++) {
+            const uint32_t c = cy * cells_per_side + cx;
+            for(uint32_t i = cell_start[c]; i < cell_start[c + 1]; i++) {
+                const uint32_t u = by_cell[i];
+                // the same cell and the neighboring cells that come after it
+                for(uint32_t dy = 0; dy <= 1; dy++) {
+                    for(int dx = dy == 0 ? 0 : -1; dx <= 1; dx++) {
+                        const int64_t nx = (int64_t)cx + dx, ny = (int64_t)cy + dy;
+                        if(nx < 0 || nx >= cells_per_side || ny >= cells_per_side) {
+                            continue;
+                        }
+                        const uint32_t d = (uint32_t)ny * cells_per_side + (uint32_t)nx;
+                        for(uint32_t j = d == c ? i + 1 : cell_start[d]; j < cell_start[d + 1]; j++) {
+                            const uint32_t v = by_cell[j];
+                            const double ex = x[u] - x[v], ey = y[u] - y[v];
+                            if(ex * ex + ey * ey <= radius * radius) {
+                                _add_edge(list, u + 1, v + 1);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    free(x);
+    free(y);
+    free(cell_start);
+    free(by_cell);
+    free(cell_of);
+}
+
+
+
+// returns the number of vertices, which is the smallest product of the side lengths that is at least n
+static uint32_t _generate_grid(EdgeList* list, uint32_t n)
+{
+    const uint32_t width = (uint32_t)ceil(sqrt((double)n));
+    const uint32_t height = (n + width - 1) / width;
+    for(uint32_t row = 0; row < height; row++) {
+        for(uint32_t col = 0; col < width; col++) {
+            const uint32_t v = row * width + col + 1;
+            if(col + 1 < width) {
+                _add_edge(list, v, v + 1);
+            }
+            if(row + 1 < height) {
+                _add_edge(list, v, v + width);
+            }
+        }
+    }
+    return width * height;
+}
+
+
+
+// Every new vertex is connected to edges_per_vertex endpoints of random existing edges, which picks the
+// vertices proportionally to their degree. The first vertices form a path.
+static void _generate_ba(EdgeList* list, uint32_t n, uint32_t edges_per_vertex, fast_random_t* rng)
+{
+    for(uint32_t v = 2; v <= n && v <= edges_per_vertex + 1; v++) {
+        _add_edge(list, v - 1, v);
+    }
+    for(uint32_t v = edges_per_vertex + 2; v <= n; v++) {
+        const size_t existing = list->count;
+        for(uint32_t i = 0; i < edges_per_vertex; i++) {
+            const uint64_t edge = list->edges[fast_random(rng) % existing];
+            _add_edge(list, v, (fast_random(rng) & 1) ? (uint32_t)(edge >> 32) : (uint32_t)edge);
+        }
+    }
+}
+
+
+
+// The intersections form a grid, and each street between two of them exists with street_probability and
+// has a geometrically distributed number of vertices of degree 2 on it. The vertex count stops at about n.
+// returns the number of vertices
+static uint32_t _generate_road(EdgeList* list, uint32_t n, double street_probability, fast_random_t* rng)
+{
+    // expected vertices per intersection: 1 + 2 streets * p * (expected subdivisions of a street)
+    const double per_intersection =
+        1.0 + 2.0 * street_probability * ROAD_SUBDIVISION_PROBABILITY / (1.0 - ROAD_SUBDIVISION_PROBABILITY);
+    const uint32_t width = (uint32_t)ceil(sqrt((double)n / per_intersection));
+    const uint32_t intersections = width * width;
+    uint32_t next_id = intersections + 1;
+    for(uint32_t v = 1; v <= intersections; v++) {
+        const uint32_t col = (v - 1) % width;
+        const uint32_t ends[2] = {col + 1 < width ? v + 1 : 0, v + width <= intersections ? v + width : 0};
+        for(int i = 0; i < 2; i++) {
+            if(ends[i] == 0 || _random_unit(rng) >= street_probability) {
+                continue;
+            }
+            uint32_t last = v;
+            while(next_id <= n && _random_unit(rng) < ROAD_SUBDIVISION_PROBABILITY) {
+                _add_edge(list, last, next_id);
+                last = next_id++;
+            }
+            _add_edge(list, last, ends[i]);
+        }
+    }
+    return next_id - 1;
+}
+
+
+
+static double _parse_param(const char* arg, double default_value)
+{
+    if(arg == NULL) {
+        return default_value;
+    }
+    char* end;
+    const double value = strtod(arg, &end);
+    if(*end != '\0' || !(value > 0.0)) {
+        fprintf(stderr, "generate_graph: invalid parameter '%s'\n", arg);
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    if(argc < 4 || argc > 5) {
+        fprintf(stderr, "Usage: %s er|geometric|grid|ba|road N SEED [PARAM] > graph.gr\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    const char* graph_class = argv[1];
+    const unsigned long n_arg = strtoul(argv[2], NULL, 10);
+    if(n_arg < 2 || n_arg > UINT32_MAX / 2) {
+        fprintf(stderr, "generate_graph: invalid number of vertices '%s'\n", argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    uint32_t n = (uint32_t)n_arg;
+    const char* param = argc == 5 ? argv[4] : NULL;
+    fast_random_t rng;
+    fast_random_init(&rng, strtoull(argv[3], NULL, 10));
+
+    EdgeList list = {.edges = NULL, .count = 0, .capacity = 0};
+    if(strcmp(graph_class, "er") == 0) {
+        _generate_er(&list, n, _parse_param(param, 6.0), &rng);
+    }
+    else if(strcmp(graph_class, "geometric") == 0) {
+        _generate_geometric(&list, n, _parse_param(param, 6.0), &rng);
+    }
+    else if(strcmp(graph_class, "grid") == 0) {
+        n = _generate_grid(&list, n);
+    }
+    else if(strcmp(graph_class, "ba") == 0) {
+        _generate_ba(&list, n, (uint32_t)ceil(_parse_param(param, 3.0)), &rng);
+    }
+    else if(strcmp(graph_class, "road") == 0) {
+        n = _generate_road(&list, n, _parse_param(param, 0.65), &rng);
+    }
+    else {
+        fprintf(stderr, "generate_graph: unknown graph class '%s'\n", graph_class);
+        exit(EXIT_FAILURE);
+    }
+
+    // remove the duplicates, the solver expects a simple graph
+    if(list.count > 0) {
+        qsort(list.edges, list.count, sizeof(uint64_t), _compare_edges);
+    }
+    size_t m = 0;
+    for(size_t i = 0; i < list.count; i++) {
+        if(m == 0 || list.edges[i] != list.edges[m - 1]) {
+            list.edges[m++] = list.edges[i];
+        }
+    }
+    printf("c %s graph, generated by generate_graph %s %s %s%s%s\n", graph_class, graph_class, argv[2], argv[3],
+           param != NULL ? " " : "", param != NULL ? param : "");
+    printf("p ds %" PRIu32 " %zu\n", n, m);
+    for(size_t i = 0; i < m; i++) {
+        printf("%" PRIu32 " %" PRIu32 "\n", (uint32_t)(list.edges[i] >> 32), (uint32_t)list.edges[i]);
+    }
+    free(list.edges);
+    if(fflush(stdout) != 0) {
+        perror("generate_graph: writing the graph failed");
+        exit(EXIT_FAILURE);
+    }
+    return EXIT_SUCCESS;
+}
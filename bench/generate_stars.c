@@ -0,0 +1,125 @@
+// Streams a graph that is too large to be generated in memory, for the check of edge counts beyond 2^32 in
+// bench/large_edges.sh: CENTERS star centers with the ids 1, ..., CENTERS, which are all adjacent to the same
+// LEAVES leaves with the ids CENTERS + 1, ..., CENTERS + LEAVES (the complete bipartite graph). It has
+// CENTERS * LEAVES edges, and {1, CENTERS + 1} dominates it.
+// The edges are written center by center, with the leaf id counted up in decimal, so it runs at disk speed.
+// Usage: generate_stars CENTERS LEAVES > graph.gr
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+
+
+#define OUTPUT_BUFFER_SIZE (1u << 22)
+#define MAX_DIGITS         20 // of a uint64_t
+#define MAX_LINE_LENGTH    (2 * MAX_DIGITS + 2)
+
+
+
+static char _g_buffer[OUTPUT_BUFFER_SIZE];
+static size_t _g_used = 0;
+
+
+
+static void _flush(void)
+{
+    if(fwrite(_g_buffer, 1, _g_used, stdout) != _g_used) {
+        perror("generate_stars: writing the graph failed");
+        exit(EXIT_FAILURE);
+    }
+    _g_used = 0;
+}
+
+
+
+// a decimal number that is counted up in place: the digits are digits[first], ..., digits[MAX_DIGITS - 1]
+typedef struct Counter {
+    char digits[MAX_DIGITS];
+    int first;
+} Counter;
+
+
+
+static void _counter_set(Counter* counter, uint64_t value)
+{
+    memset(counter->digits, '0', MAX_DIGITS);
+    counter->first = MAX_DIGITS;
+    do {
+        counter->digits[--counter->first] = (char)('0' + value % 10);
+        value /= 10;
+    } while(value > 0);
+}
+
+
+
+static void _counter_increment(Counter* counter)
+{
+    int i = MAX_DIGITS - 1;
+    while(counter->digits[i] == '9') {
+        counter->digits[i--] = '0';
+    }
+    counter->digits[i]++; // the digits before first are '0', so a carry out of the first digit adds a new one
+    if(i < counter->first) {
+        counter->first = i;
+    }
+}
+
+
+
+static uint64_t _parse_count(const char* arg, uint64_t max)
+{
+    char* end;
+    const unsigned long long value = strtoull(arg, &end, 10);
+    if(end == arg || *end != '\0' || value == 0 || value > max) {
+        fprintf(stderr, "generate_stars: invalid count '%s'\n", arg);
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    if(argc != 3) {
+        fprintf(stderr, "Usage: %s CENTERS LEAVES > graph.gr\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    const uint64_t centers = _parse_count(argv[1], UINT32_MAX - 2);
+    const uint64_t leaves = _parse_count(argv[2], UINT32_MAX - 1 - centers); // n must stay below UINT32_MAX
+
+    printf("c %" PRIu64 " stars with the same %" PRIu64 " leaves, generated by generate_stars %s %s\n", centers,
+           leaves, argv[1], argv[2]);
+    printf("p ds %" PRIu64 " %" PRIu64 "\n", centers + leaves, centers * leaves);
+    fflush(stdout);
+
+    Counter center, leaf;
+    _counter_set(&center, 1);
+    for(uint64_t c = 0; c < centers; c++) {
+        char prefix[MAX_DIGITS + 1];
+        const size_t prefix_length = (size_t)(MAX_DIGITS - center.first) + 1;
+        memcpy(prefix, center.digits + center.first, prefix_length - 1);
+        prefix[prefix_length - 1] = ' ';
+        _counter_set(&leaf, centers + 1);
+        for(uint64_t l = 0; l < leaves; l++) {
+            if(_g_used + MAX_LINE_LENGTH > OUTPUT_BUFFER_SIZE) {
+                _flush();
+            }
+            const size_t leaf_length = (size_t)(MAX_DIGITS - leaf.first);
+            memcpy(_g_buffer + _g_used, prefix, prefix_length);
+            memcpy(_g_buffer + _g_used + prefix_length, leaf.digits + leaf.first, leaf_length);
+            _g_used += prefix_length + leaf_length;
+            _g_buffer[_g_used++] = '\n';
+            _counter_increment(&leaf);
+        }
+        _counter_increment(&center);
+    }
+    _flush();
+    if(fflush(stdout) != 0) {
+        perror("generate_stars: writing the graph failed");
+        exit(EXIT_FAILURE);
+    }
+    return EXIT_SUCCESS;
+}
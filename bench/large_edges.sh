@@ -0,0 +1,41 @@
+#!/bin/sh
+# Checks a graph with more than 2^32 edges end to end: generates it with generate_stars (9 stars with the same
+# 477218589 leaves, 4294967301 edges, about 51 GB on disk), checks a dominating set and a set that leaves the other
+# centers undominated with verify_solution, which maps the file and counts the edges in 64 bit, and deletes the graph.
+# The edge counts on the paths that allocate per edge are checked without such a file by bench/edge_count_check.c.
+# Usually run by `make large_edges`. Environment variables:
+#   LARGE_VERIFY  the verify_solution to run (default build/release/verify_solution)
+#   LARGE_DIR     where the graph is written, needs about 51 GB (default build/bench)
+
+set -e
+
+LARGE_VERIFY=${LARGE_VERIFY:-build/release/verify_solution}
+LARGE_DIR=${LARGE_DIR:-build/bench}
+GENERATOR=$LARGE_DIR/generate_stars
+CENTERS=9
+LEAVES=477218589
+EXPECTED_GRAPH="graph: n == $((CENTERS + LEAVES)), m == $((CENTERS * LEAVES))"
+
+graph=$LARGE_DIR/stars.gr
+trap 'rm -f "$graph" "$LARGE_DIR/stars_valid.ds" "$LARGE_DIR/stars_invalid.ds"' EXIT
+
+# the center 1 dominates the leaves, the leaf CENTERS + 1 the centers
+printf '2\n1\n%s\n' $((CENTERS + 1)) > "$LARGE_DIR/stars_valid.ds"
+printf '1\n1\n' > "$LARGE_DIR/stars_invalid.ds"
+
+echo "generating $graph"
+"$GENERATOR" $CENTERS $LEAVES > "$graph"
+ls -l "$graph"
+
+check() { # solution, expected exit status, expected line
+    status=0
+    output=$("$LARGE_VERIFY" "$graph" "$1") || status=$?
+    echo "$output"
+    if [ "$status" -ne "$2" ] || ! echo "$output" | grep -qxF "$EXPECTED_GRAPH" || ! echo "$output" | grep -qF "$3"; then
+        echo "large_edges: unexpected result for $1" >&2
+        exit 1
+    fi
+}
+check "$LARGE_DIR/stars_valid.ds" 0 "valid dominating set"
+check "$LARGE_DIR/stars_invalid.ds" 1 "undominated vertices: $((CENTERS - 1)) (2 3 4 5 6 7 8 9)"
+echo "large_edges: ok"
@@ -0,0 +1,44 @@
+#!/bin/sh
+# Runs the whole solver on a graph with more than 2^32 edges: graph_parse, reduce, kernel_from_graph and the search
+# of heuristic_solver on the graph of bench/large_edges.sh (9 stars with the same 477218589 leaves, 4294967301 edges,
+# about 51 GB on disk). The reduction fixes a center and a leaf, so the kernel is empty and the optimum of 2 is
+# expected. The statistics must report the full edge count, and the solution is checked with verify_solution.
+# The parsed graph needs about 32 bytes per edge, so the full size needs about 140 GB of memory. Smaller sizes with
+# the same shape are set with LARGE_LEAVES (the solver path is then not beyond 2^32 edges).
+# Usually run by `make large_solve`. Environment variables:
+#   LARGE_SOLVER      the heuristic_solver to run (default build/release/heuristic_solver)
+#   LARGE_VERIFY      the verify_solution to run (default build/release/verify_solution)
+#   LARGE_DIR         where the graph is written, needs about 51 GB (default build/bench)
+#   LARGE_LEAVES      the number of leaves (default 477218589)
+#   LARGE_TIME_LIMIT  the time limit of the solver in seconds (default 3600)
+
+set -e
+
+LARGE_SOLVER=${LARGE_SOLVER:-build/release/heuristic_solver}
+LARGE_VERIFY=${LARGE_VERIFY:-build/release/verify_solution}
+LARGE_DIR=${LARGE_DIR:-build/bench}
+LARGE_LEAVES=${LARGE_LEAVES:-477218589}
+LARGE_TIME_LIMIT=${LARGE_TIME_LIMIT:-3600}
+GENERATOR=$LARGE_DIR/generate_stars
+CENTERS=9
+EXPECTED_INPUT="\"input\": {\"n\": $((CENTERS + LARGE_LEAVES)), \"m\": $((CENTERS * LARGE_LEAVES)), \"incomplete\": false}"
+
+graph=$LARGE_DIR/stars.gr
+solution=$LARGE_DIR/stars_solver.ds
+stats=$LARGE_DIR/stars_stats.json
+trap 'rm -f "$graph" "$solution" "$stats"' EXIT
+
+echo "generating $graph"
+"$GENERATOR" $CENTERS "$LARGE_LEAVES" > "$graph"
+ls -l "$graph"
+
+fail() {
+    echo "large_solve: $1" >&2
+    exit 1
+}
+"$LARGE_SOLVER" --time-limit "$LARGE_TIME_LIMIT" --stats "$stats" < "$graph" > "$solution" || fail "the solver failed"
+cat "$stats"
+grep -qF "$EXPECTED_INPUT" "$stats" || fail "unexpected input size, expected $EXPECTED_INPUT"
+[ "$(head -n 1 "$solution")" = 2 ] || fail "the solution is not optimal, expected 2 vertices"
+"$LARGE_VERIFY" "$graph" "$solution" || fail "the solution is not valid"
+echo "large_solve: ok"
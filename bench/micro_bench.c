@@ -0,0 +1,356 @@
+// Micro benchmarks of single components, so that changes to their hot paths can be measured in isolation:
+// the priority queue with the key patterns of the greedy construction, the parser, and the single reduction
+// rules on crafted neighborhoods, from a few vertices up to high degree hubs.
+// Every case prints the time and the heap allocations (malloc, calloc, realloc and free, see
+// alloc_counter.h) per operation. Build and run with `make micro_bench`.
+
+// the rules are static, so the reduction is compiled as part of this file
+#include "../src/reduction.c"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <float.h>
+#include <time.h>
+
+#include "graph.h"
+#include "pqueue.h"
+#include "alloc_counter.h"
+#include "fast_random.h"
+
+
+
+#define PQ_VALUES             (1u << 20)
+#define PQ_GREEDY_DECREASES   4 // decreased keys per pop in the greedy pattern, like the neighbors of a chosen vertex
+#define PARSE_VERTICES        (1u << 20)
+#define PARSE_EDGES_PER_VERTEX 3
+#define PARSE_ROUNDS          3 // the fastest round is reported
+#define RULE_TOTAL_VERTICES   (1u << 20) // the copies of a crafted neighborhood have about x vertices in total
+#define RULE_ROUNDS           16 // rules that do not change the graph are applied to every copy x times
+
+
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1.e-9 * (double)ts.tv_nsec;
+}
+
+
+
+static void _report(const char* name, double seconds, double count, size_t allocations, const char* extra)
+{
+    printf("%-56s %10.1f ns/op %8.2f allocs/op  %s\n", name, 1.e9 * seconds / count, (double)allocations / count,
+           extra);
+}
+
+
+
+// the keys of the greedy construction: the number of undominated vertices that a vertex would dominate,
+// mostly small with many ties, and large for a few hubs
+static pq_keytype _degree_key(fast_random_t* rng)
+{
+    const uint64_t r = fast_random(rng);
+    return (pq_keytype)((r & 1023) == 0 ? 16 + (r >> 10) % 4096 : 1 + (r >> 10) % 16);
+}
+
+
+
+static void _bench_pqueue(void)
+{
+    PQueue* q = pq_new(PQ_VALUES);
+    if(!q) {
+        perror("micro_bench: pq_new failed");
+        exit(EXIT_FAILURE);
+    }
+    fast_random_t rng;
+    fast_random_init(&rng, 42);
+    uint64_t sink = 0;
+    char extra[64];
+
+    size_t allocations = alloc_counter_get();
+    double start = _now();
+    for(uint32_t v = 0; v < PQ_VALUES; v++) {
+        pq_insert(q, (KeyValPair) {.key = _degree_key(&rng), .val = v});
+    }
+    _report("pq_insert, degree keys", _now() - start, PQ_VALUES, alloc_counter_get() - allocations, "");
+
+    allocations = alloc_counter_get();
+    start = _now();
+    for(uint32_t i = 0; i < PQ_VALUES; i++) {
+        const uint32_t v = (uint32_t)(fast_random(&rng) % PQ_VALUES);
+        const pq_keytype key = pq_get_key(q, v);
+        if(key > 0) {
+            pq_decrease_priority(q, v, key - 1);
+        }
+    }
+    _report("pq_decrease_priority by 1, random values", _now() - start, PQ_VALUES, alloc_counter_get() - allocations,
+            "");
+
+    allocations = alloc_counter_get();
+    start = _now();
+    while(!pq_is_empty(q)) {
+        sink += pq_pop(q).val;
+    }
+    snprintf(extra, sizeof(extra), "(sink %" PRIu64 ")", sink);
+    _report("pq_pop until empty", _now() - start, PQ_VALUES, alloc_counter_get() - allocations, extra);
+
+    // the greedy construction: pop the best vertex, then decrease the keys of some of the remaining vertices
+    for(uint32_t v = 0; v < PQ_VALUES; v++) {
+        pq_insert(q, (KeyValPair) {.key = _degree_key(&rng), .val = v});
+    }
+    size_t operations = 0;
+    allocations = alloc_counter_get();
+    start = _now();
+    while(!pq_is_empty(q)) {
+        sink += pq_pop(q).val;
+        operations++;
+        for(int i = 0; i < PQ_GREEDY_DECREASES; i++) {
+            const uint32_t v = (uint32_t)(fast_random(&rng) % PQ_VALUES);
+            if(pq_contains(q, v)) {
+                const pq_keytype key = pq_get_key(q, v);
+                if(key > 0) {
+                    pq_decrease_priority(q, v, key - 1);
+                    operations++;
+                }
+            }
+        }
+    }
+    snprintf(extra, sizeof(extra), "(sink %" PRIu64 ")", sink);
+    _report("greedy pattern, pop and decrease", _now() - start, (double)operations,
+            alloc_counter_get() - allocations, extra);
+    pq_free(q);
+}
+
+
+
+// write a random graph in the PACE format to a new buffer, which the caller has to free
+static char* _random_graph_text(uint32_t n, uint32_t m, size_t* size)
+{
+    char* text;
+    FILE* out = open_memstream(&text, size);
+    if(!out) {
+        perror("micro_bench: open_memstream failed");
+        exit(EXIT_FAILURE);
+    }
+    fast_random_t rng;
+    fast_random_init(&rng, 1);
+    fprintf(out, "p ds %" PRIu32 " %" PRIu32 "\n", n, m);
+    for(uint32_t i = 0; i < m; i++) {
+        const uint32_t u = 1 + (uint32_t)(fast_random(&rng) % n);
+        const uint32_t v = 1 + (u + (uint32_t)(fast_random(&rng) % (n - 1))) % n; // never u
+        fprintf(out, "%" PRIu32 " %" PRIu32 "\n", u, v);
+    }
+    if(fclose(out) != 0) {
+        perror("micro_bench: writing the graph failed");
+        exit(EXIT_FAILURE);
+    }
+    return text;
+}
+
+
+
+// parse the graph in text, exits on failure
+static Graph* _parse_text(const char* text, size_t size)
+{
+    atomic_bool never_set;
+    atomic_init(&never_set, false);
+    const StopCondition stop = {.flag = &never_set, .deadline = DBL_MAX};
+    FILE* input = fmemopen((void*)(uintptr_t)text, size, "r");
+    if(!input) {
+        perror("micro_bench: fmemopen failed");
+        exit(EXIT_FAILURE);
+    }
+    Graph* g = graph_parse(input, &stop);
+    fclose(input);
+    if(!g) {
+        exit(EXIT_FAILURE);
+    }
+    return g;
+}
+
+
+
+static void _bench_parse(void)
+{
+    const uint32_t m = PARSE_VERTICES * PARSE_EDGES_PER_VERTEX;
+    size_t size;
+    char* text = _random_graph_text(PARSE_VERTICES, m, &size);
+    double best = DBL_MAX;
+    size_t allocations = 0;
+    for(int round = 0; round < PARSE_ROUNDS; round++) {
+        const size_t allocations_before = alloc_counter_get();
+        const double start = _now();
+        Graph* g = _parse_text(text, size);
+        const double seconds = _now() - start;
+        allocations = alloc_counter_get() - allocations_before;
+        graph_free(g);
+        best = seconds < best ? seconds : best;
+    }
+    char extra[64];
+    snprintf(extra, sizeof(extra), "%.1f MB/s, %zu allocs per parse", (double)size / best / 1.e6, allocations);
+    _report("graph_parse, per edge", best, m, allocations, extra);
+    free(text);
+}
+
+
+
+// The crafted neighborhoods. Every shape consists of the vertices v and w (the first two ids of a copy)
+// and degree other vertices x_1, ..., x_degree.
+typedef enum Shape {
+    SHAPE_SHARED,  // the x_i are adjacent to both v and w, and each has `outside` leaves of its own
+    SHAPE_PATH,    // the x_i are adjacent to v and form a path, w is isolated
+    SHAPE_PRIVATE, // half of the x_i are adjacent to v only, the other half to w only
+} Shape;
+
+
+typedef enum Rule {
+    RULE_REDUNDANT, // _is_redundant(v), with v dominated
+    RULE_1,         // _rule_1_reduce_vertex(v)
+    RULE_2,         // _rule_2_reduce_vertices(v, w)
+} Rule;
+
+
+
+// write the edges of one copy of the shape, whose vertices start at first_id, and add their number to *m.
+// returns the number of vertices of the copy
+static uint32_t _shape_edges(FILE* out, Shape shape, uint32_t first_id, uint32_t degree, uint32_t outside,
+                             uint32_t* m)
+{
+    const uint32_t v = first_id, w = first_id + 1, x = first_id + 2;
+    uint32_t next_id = x + degree;
+    for(uint32_t i = 0; i < degree; i++) {
+        switch(shape) {
+            case SHAPE_SHARED:
+                fprintf(out, "%" PRIu32 " %" PRIu32 "\n%" PRIu32 " %" PRIu32 "\n", v, x + i, w, x + i);
+                *m += 2;
+                for(uint32_t leaf = 0; leaf < outside; leaf++) {
+                    fprintf(out, "%" PRIu32 " %" PRIu32 "\n", x + i, next_id++);
+                    (*m)++;
+                }
+                break;
+            case SHAPE_PATH:
+                fprintf(out, "%" PRIu32 " %" PRIu32 "\n", v, x + i);
+                (*m)++;
+                if(i > 0) {
+                    fprintf(out, "%" PRIu32 " %" PRIu32 "\n", x + i - 1, x + i);
+                    (*m)++;
+                }
+                break;
+            default: // SHAPE_PRIVATE
+                fprintf(out, "%" PRIu32 " %" PRIu32 "\n", i % 2 == 0 ? v : w, x + i);
+                (*m)++;
+                break;
+        }
+    }
+    return next_id - first_id;
+}
+
+
+
+// a graph of disjoint copies of the shape with about RULE_TOTAL_VERTICES vertices. The v of copy i is
+// g->vertices[i * *copy_size], and its w is the next vertex.
+static Graph* _crafted_graph(Shape shape, uint32_t degree, uint32_t outside, uint32_t* copies, uint32_t* copy_size)
+{
+    char* edges;
+    size_t edges_size;
+    FILE* out = open_memstream(&edges, &edges_size);
+    if(!out) {
+        perror("micro_bench: open_memstream failed");
+        exit(EXIT_FAILURE);
+    }
+    uint32_t m = 0;
+    *copy_size = _shape_edges(out, shape, 1, degree, outside, &m);
+    *copies = RULE_TOTAL_VERTICES / *copy_size > 0 ? RULE_TOTAL_VERTICES / *copy_size : 1;
+    for(uint32_t copy = 1; copy < *copies; copy++) {
+        _shape_edges(out, shape, 1 + copy * *copy_size, degree, outside, &m);
+    }
+    fclose(out);
+    char* text;
+    size_t size;
+    out = open_memstream(&text, &size);
+    if(!out) {
+        perror("micro_bench: open_memstream failed");
+        exit(EXIT_FAILURE);
+    }
+    fprintf(out, "p ds %" PRIu32 " %" PRIu32 "\n", *copies * *copy_size, m);
+    fwrite(edges, 1, edges_size, out);
+    fclose(out);
+    free(edges);
+    Graph* g = _parse_text(text, size);
+    free(text);
+    return g;
+}
+
+
+
+// apply the rule to the v (and w) of every copy of the shape, RULE_ROUNDS times unless it changes the graph
+static void _bench_rule(const char* name, Rule rule, Shape shape, uint32_t degree, uint32_t outside)
+{
+    uint32_t copies, copy_size;
+    Graph* g = _crafted_graph(shape, degree, outside, &copies, &copy_size);
+    for(uint32_t copy = 0; copy < copies && rule == RULE_REDUNDANT; copy++) {
+        g->vertices[copy * copy_size]->dominated_by_number = 1;
+    }
+    size_t calls = 0, reduced = 0;
+    const size_t allocations = alloc_counter_get();
+    const double start = _now();
+    // rule 1 and rule 2 change the graph if they reduce, so they cannot be applied to the same copy again
+    for(int round = 0; round < RULE_ROUNDS && (round == 0 || rule == RULE_REDUNDANT || reduced == 0); round++) {
+        for(uint32_t copy = 0; copy < copies; copy++) {
+            Vertex* v = g->vertices[copy * copy_size];
+            Vertex* w = g->vertices[copy * copy_size + 1];
+            bool result;
+            switch(rule) {
+                case RULE_REDUNDANT:
+                    result = _is_redundant(v);
+                    break;
+                case RULE_1:
+                    result = _rule_1_reduce_vertex(g, v);
+                    break;
+                default: // RULE_2
+                    result = _rule_2_reduce_vertices(g, v, w);
+                    break;
+            }
+            calls++;
+            if(result) {
+                reduced++;
+            }
+        }
+    }
+    const double seconds = _now() - start;
+    char extra[64];
+    const char* outcome = rule == RULE_REDUNDANT ? (reduced == 0 ? "not redundant" : "redundant")
+                                                 : (reduced == 0 ? "no reduction" : "reduces");
+    snprintf(extra, sizeof(extra), "(%s, %" PRIu32 " copies)", outcome, copies);
+    _report(name, seconds, (double)calls, alloc_counter_get() - allocations, extra);
+    graph_free(g);
+}
+
+
+
+int main(void)
+{
+    printf("priority queue (%u values):\n", PQ_VALUES);
+    _bench_pqueue();
+    printf("parser (%u vertices, %u edges):\n", PARSE_VERTICES, PARSE_VERTICES * PARSE_EDGES_PER_VERTEX);
+    _bench_parse();
+    printf("reduction rules (per call):\n");
+    _bench_rule("_is_redundant, degree 8, 2 leaves per neighbor", RULE_REDUNDANT, SHAPE_SHARED, 8, 2);
+    _bench_rule("_is_redundant, degree 64, 4 leaves per neighbor", RULE_REDUNDANT, SHAPE_SHARED, 64, 4);
+    _bench_rule("_is_redundant, hub of degree 4096", RULE_REDUNDANT, SHAPE_SHARED, 4096, 4);
+    _bench_rule("_rule_1_reduce_vertex, degree 8, 2 leaves per neighbor", RULE_1, SHAPE_SHARED, 8, 2);
+    _bench_rule("_rule_1_reduce_vertex, degree 64, 4 leaves per neighbor", RULE_1, SHAPE_SHARED, 64, 4);
+    _bench_rule("_rule_1_reduce_vertex, hub of degree 4096", RULE_1, SHAPE_SHARED, 4096, 4);
+    _bench_rule("_rule_1_reduce_vertex, degree 8, path of neighbors", RULE_1, SHAPE_PATH, 8, 0);
+    _bench_rule("_rule_1_reduce_vertex, degree 64, path of neighbors", RULE_1, SHAPE_PATH, 64, 0);
+    _bench_rule("_rule_2_reduce_vertices, 8 shared, 2 leaves each", RULE_2, SHAPE_SHARED, 8, 2);
+    _bench_rule("_rule_2_reduce_vertices, 64 shared, 4 leaves each", RULE_2, SHAPE_SHARED, 64, 4);
+    _bench_rule("_rule_2_reduce_vertices, hubs with 4096 shared", RULE_2, SHAPE_SHARED, 4096, 4);
+    _bench_rule("_rule_2_reduce_vertices, 64 shared without leaves", RULE_2, SHAPE_SHARED, 64, 0);
+    _bench_rule("_rule_2_reduce_vertices, 8 private", RULE_2, SHAPE_PRIVATE, 8, 0);
+    _bench_rule("_rule_2_reduce_vertices, 64 private", RULE_2, SHAPE_PRIVATE, 64, 0);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+# The training workload of the profile guided build (`make pgo`): generates a few smaller graphs of the
+# classes of the benchmark suite (with other seeds, so that the build is not trained on the benchmark graphs
+# themselves) and solves each of them with the instrumented solver, which writes the profile at exit.
+# The runs cover the default single threaded search, the parallel modes and the cc engine in the proportion
+# in which they are usually used. Environment variables (all set by the Makefile):
+#   PGO_SOLVER  the instrumented heuristic_solver
+#   PGO_TIME    the time limit per run in seconds (default 5)
+#   PGO_DIR     where the graphs are written (in PGO_DIR/graphs)
+#   GENERATOR   the generate_graph executable
+
+set -e
+
+PGO_TIME=${PGO_TIME:-5}
+SEED=2
+
+# name, generator class, number of vertices, generator seed, generator parameter, solver options
+RUNS="
+er_20k          er        20000  2 6    -
+geometric_50k   geometric 50000  2 8    -
+grid_40k        grid      40000  2 -    -
+ba_20k          ba        20000  2 3    -
+road_60k        road      60000  2 0.65 -
+road_60k        road      60000  2 0.65 --threads|2
+geometric_50k   geometric 50000  2 8    --threads|2|--partition
+er_20k          er        20000  2 6    --engine|cc
+"
+
+mkdir -p "$PGO_DIR/graphs"
+echo "$RUNS" | while read -r name graph_class n graph_seed param options; do
+    [ -n "$name" ] || continue
+    graph=$PGO_DIR/graphs/$name.gr
+    if [ ! -f "$graph" ]; then
+        if [ "$param" = "-" ]; then
+            "$GENERATOR" "$graph_class" "$n" "$graph_seed" > "$graph.tmp"
+        else
+            "$GENERATOR" "$graph_class" "$n" "$graph_seed" "$param" > "$graph.tmp"
+        fi
+        mv "$graph.tmp" "$graph"
+    fi
+    [ "$options" = "-" ] && options=""
+    echo "  $name $(echo "$options" | tr '|' ' ')"
+    # shellcheck disable=SC2046 # the options are split on purpose
+    "$PGO_SOLVER" --seed "$SEED" --time-limit "$PGO_TIME" $(echo "$options" | tr '|' ' ') \
+        < "$graph" > /dev/null 2> /dev/null
+done
@@ -0,0 +1,156 @@
+// Compares the random number generator in src/fast_random.h with the linear congruential generator it
+// replaced, both for single numbers and for the removal sweep of the random deconstruction.
+// Build and run with `make rng_bench`.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "fast_random.h"
+
+
+
+#define COUNT_NUMBERS (1u << 27)
+#define SWEEP_VERTICES (1u << 20)
+#define SWEEP_ROUNDS 200
+#define SWEEP_BLOCK_SIZE 256
+#define SWEEP_REMOVAL_PROBABILITY 0.006
+
+
+
+// the generator fast_random.h used before, for comparison
+typedef struct {
+    uint64_t state;
+} lcg_t;
+
+static inline uint64_t lcg_random(lcg_t* rng)
+{
+    rng->state = 0xd1342543de82ef95ULL * rng->state + 1ULL;
+    return rng->state;
+}
+
+
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1.e-9 * (double)ts.tv_nsec;
+}
+
+
+
+static void _report(const char* name, double seconds, double count, uint64_t sink)
+{
+    // the sink is printed so that the compiler cannot optimize the benchmarked loops away
+    printf("%-34s %8.3f ns/op  (sink %016llx)\n", name, 1.e9 * seconds / count, (unsigned long long)sink);
+}
+
+
+
+static void _bench_numbers(void)
+{
+    uint64_t sink = 0;
+    lcg_t lcg = {.state = 42};
+    double start = _now();
+    for(uint32_t i = 0; i < COUNT_NUMBERS; i++) {
+        sink ^= lcg_random(&lcg);
+    }
+    _report("lcg (previous fast_random)", _now() - start, COUNT_NUMBERS, sink);
+
+    fast_random_t rng;
+    fast_random_init(&rng, 42);
+    sink = 0;
+    start = _now();
+    for(uint32_t i = 0; i < COUNT_NUMBERS; i++) {
+        sink ^= fast_random(&rng);
+    }
+    _report("xoshiro256++ fast_random", _now() - start, COUNT_NUMBERS, sink);
+
+    fast_random_bulk_t bulk;
+    fast_random_bulk_init(&bulk, 42);
+    uint64_t buffer[SWEEP_BLOCK_SIZE];
+    sink = 0;
+    start = _now();
+    for(uint32_t i = 0; i < COUNT_NUMBERS; i += SWEEP_BLOCK_SIZE) {
+        fast_random_fill(&bulk, buffer, SWEEP_BLOCK_SIZE);
+        for(uint32_t j = 0; j < SWEEP_BLOCK_SIZE; j++) {
+            sink ^= buffer[j];
+        }
+    }
+    _report("xoshiro256++ fast_random_fill", _now() - start, COUNT_NUMBERS, sink);
+}
+
+
+
+// the loop of the random deconstruction: select every ds vertex with a small probability
+static void _bench_sweep(void)
+{
+    bool* is_in_ds = malloc(SWEEP_VERTICES * sizeof(bool));
+    if(!is_in_ds) {
+        perror("rng_bench: malloc failed");
+        exit(EXIT_FAILURE);
+    }
+    fast_random_t setup_rng;
+    fast_random_init(&setup_rng, 7);
+    for(uint32_t v = 0; v < SWEEP_VERTICES; v++) {
+        is_in_ds[v] = fast_random(&setup_rng) % 5 == 0; // like a typical solution, 20 % of the vertices are in the ds
+    }
+    const uint64_t threshold = (uint64_t)(SWEEP_REMOVAL_PROBABILITY * (double)FAST_RANDOM_MAX);
+    const double count = (double)SWEEP_VERTICES * SWEEP_ROUNDS;
+
+    uint64_t selected = 0;
+    lcg_t lcg = {.state = 42};
+    double start = _now();
+    for(int round = 0; round < SWEEP_ROUNDS; round++) {
+        for(uint32_t v = 0; v < SWEEP_VERTICES; v++) {
+            if(is_in_ds[v] && lcg_random(&lcg) < threshold) {
+                selected += v;
+            }
+        }
+    }
+    _report("sweep, lcg per ds vertex", _now() - start, count, selected);
+
+    selected = 0;
+    fast_random_t rng;
+    fast_random_init(&rng, 42);
+    start = _now();
+    for(int round = 0; round < SWEEP_ROUNDS; round++) {
+        for(uint32_t v = 0; v < SWEEP_VERTICES; v++) {
+            if(is_in_ds[v] && fast_random(&rng) < threshold) {
+                selected += v;
+            }
+        }
+    }
+    _report("sweep, fast_random per ds vertex", _now() - start, count, selected);
+
+    selected = 0;
+    fast_random_bulk_t bulk;
+    fast_random_bulk_init(&bulk, 42);
+    uint64_t randoms[SWEEP_BLOCK_SIZE];
+    start = _now();
+    for(int round = 0; round < SWEEP_ROUNDS; round++) {
+        for(uint32_t block_start = 0; block_start < SWEEP_VERTICES; block_start += SWEEP_BLOCK_SIZE) {
+            fast_random_fill(&bulk, randoms, SWEEP_BLOCK_SIZE);
+            for(uint32_t i = 0; i < SWEEP_BLOCK_SIZE; i++) {
+                if(randoms[i] < threshold && is_in_ds[block_start + i]) {
+                    selected += block_start + i;
+                }
+            }
+        }
+    }
+    _report("sweep, fast_random_fill per block", _now() - start, count, selected);
+    free(is_in_ds);
+}
+
+
+
+int main(void)
+{
+    printf("random numbers (%u each):\n", COUNT_NUMBERS);
+    _bench_numbers();
+    printf("random deconstruction sweep (%u vertices, %d rounds, ns per vertex):\n", SWEEP_VERTICES, SWEEP_ROUNDS);
+    _bench_sweep();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+#!/bin/sh
+# Runs the benchmark suite: generates the synthetic graphs (once, they are kept in $BENCH_DIR/graphs), solves
+# each of them with a fixed seed and time limit, and writes the measurements of all runs to
+# $BENCH_DIR/summary.json (see solve_stats.h for the fields of each run). The summaries of two builds can be
+# compared directly, because the graphs and the seed are always the same.
+# Usually run by `make bench`. Environment variables:
+#   BENCH_SOLVER  the heuristic_solver to measure (default build/release/heuristic_solver)
+#   BENCH_TIME    the time limit per graph in seconds (default 10)
+#   BENCH_DIR     where the graphs and results are written (default build/bench)
+#   BENCH_ARGS    further options for the solver, e.g. "--threads 4"
+
+set -e
+
+BENCH_SOLVER=${BENCH_SOLVER:-build/release/heuristic_solver}
+BENCH_TIME=${BENCH_TIME:-10}
+BENCH_DIR=${BENCH_DIR:-build/bench}
+BENCH_ARGS=${BENCH_ARGS:-}
+GENERATOR=$BENCH_DIR/generate_graph
+SEED=1
+
+# name, generator class, number of vertices, generator seed, generator parameter
+GRAPHS="
+er_100k         er        100000 1 6
+geometric_200k  geometric 200000 1 8
+grid_250k       grid      250000 1 -
+ba_100k         ba        100000 1 3
+road_300k       road      300000 1 0.65
+"
+
+# the number after "key": on the line of the stats file that contains "line_key"
+# (the stats are written with one top level key per line, see solve_stats_write_json)
+json_value() { # line_key key file
+    sed -n "/\"$1\"/s/.*\"$2\": \([0-9.]*\).*/\1/p" "$3"
+}
+
+mkdir -p "$BENCH_DIR/graphs" "$BENCH_DIR/results"
+summary=$BENCH_DIR/summary.json
+{
+    printf '{\n  "solver": "%s",\n  "time_limit": %s,\n  "seed": %s,\n  "args": "%s",\n  "graphs": {' \
+        "$BENCH_SOLVER" "$BENCH_TIME" "$SEED" "$BENCH_ARGS"
+} > "$summary.tmp"
+
+printf '%-16s %10s %10s %8s %8s %10s %10s %12s %8s\n' \
+    graph n m parse_s reduce_s kernel_n kernel_m iter_per_s ds_size
+separator=""
+echo "$GRAPHS" | while read -r name graph_class n graph_seed param; do
+    [ -n "$name" ] || continue
+    graph=$BENCH_DIR/graphs/$name.gr
+    if [ ! -f "$graph" ]; then
+        if [ "$param" = "-" ]; then
+            "$GENERATOR" "$graph_class" "$n" "$graph_seed" > "$graph.tmp"
+        else
+            "$GENERATOR" "$graph_class" "$n" "$graph_seed" "$param" > "$graph.tmp"
+        fi
+        mv "$graph.tmp" "$graph"
+    fi
+    stats=$BENCH_DIR/results/$name.json
+    # shellcheck disable=SC2086 # BENCH_ARGS is split on purpose
+    "$BENCH_SOLVER" --seed "$SEED" --time-limit "$BENCH_TIME" --stats "$stats" $BENCH_ARGS \
+        < "$graph" > "$BENCH_DIR/results/$name.ds" 2> "$BENCH_DIR/results/$name.log"
+    printf '%s\n    "%s": ' "$separator" "$name" >> "$summary.tmp"
+    printf '%s' "$(sed -e '2,$s/^/    /' "$stats")" >> "$summary.tmp"
+    separator=","
+    printf '%-16s %10s %10s %8.3f %8.3f %10s %10s %12.0f %8s\n' "$name" \
+        "$(json_value input n "$stats")" "$(json_value input m "$stats")" \
+        "$(json_value parse_seconds parse_seconds "$stats")" \
+        "$(json_value reduction_seconds reduction_seconds "$stats")" \
+        "$(json_value kernel n "$stats")" "$(json_value kernel m "$stats")" \
+        "$(json_value search iterations_per_second "$stats")" "$(json_value ds_size ds_size "$stats")"
+done
+
+printf '\n  }\n}\n' >> "$summary.tmp"
+mv "$summary.tmp" "$summary"
+echo "summary written to $summary"
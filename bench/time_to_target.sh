@@ -0,0 +1,82 @@
+#!/bin/sh
+# Time-to-target analysis of several runs on the same graph, e.g. with different seeds: reads the convergence
+# traces of the runs (heuristic_solver --trace FILE) and prints for each target solution size the empirical
+# distribution of the time until a run found a solution of at most that size. Each line
+#   target  fraction  seconds
+# means that the given fraction of all runs reached the target within the given number of seconds, so the
+# lines of one target form the ECDF (the time-to-target plot) of that target. Runs that never reached the
+# target count as failures, so the fraction of the last line of a target is the success rate.
+# Usage: time_to_target.sh [-t TARGET]... trace...
+# Without -t, the targets are the best final size of all runs and that size plus 0.5 %, 1 % and 2 %.
+
+set -e
+
+targets=""
+while getopts t: option; do
+    case $option in
+        t) targets="$targets $OPTARG" ;;
+        *) echo "Usage: $0 [-t TARGET]... trace..." >&2; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 [-t TARGET]... trace..." >&2
+    exit 1
+fi
+
+awk -v targets="$targets" '
+    FNR == 1 { runs++ }
+    /^#/ || $3 == 0 { next } # the header, and the phases before the first solution
+    {
+        # the sizes in a trace only decrease, so the last line of a run is its final size
+        final[runs] = $3
+        event_count[runs]++
+        seconds[runs, event_count[runs]] = $1
+        size[runs, event_count[runs]] = $3
+    }
+    END {
+        target_count = split(targets, target)
+        if(target_count == 0) {
+            best = -1
+            for(run = 1; run <= runs; run++) {
+                if(run in final && (best < 0 || final[run] < best)) {
+                    best = final[run]
+                }
+            }
+            if(best < 0) {
+                print "time_to_target: the traces contain no solution" > "/dev/stderr"
+                exit 1
+            }
+            target_count = split(best " " int(best * 1.005) " " int(best * 1.01) " " int(best * 1.02), target)
+        }
+        print "# target\tfraction\tseconds"
+        for(t = 1; t <= target_count; t++) {
+            if(t > 1 && target[t] == target[t - 1]) {
+                continue
+            }
+            reached = 0
+            for(run = 1; run <= runs; run++) {
+                for(i = 1; i <= event_count[run]; i++) {
+                    if(size[run, i] <= target[t]) {
+                        times[++reached] = seconds[run, i]
+                        break
+                    }
+                }
+            }
+            # insertion sort, there are only a few runs
+            for(i = 2; i <= reached; i++) {
+                x = times[i]
+                for(j = i - 1; j >= 1 && times[j] > x; j--) {
+                    times[j + 1] = times[j]
+                }
+                times[j + 1] = x
+            }
+            for(i = 1; i <= reached; i++) {
+                printf "%d\t%.4f\t%s\n", target[t], i / runs, times[i]
+            }
+            if(reached == 0) {
+                printf "%d\t%.4f\t-\n", target[t], 0
+            }
+        }
+    }
+' "$@"
@@ -0,0 +1,59 @@
+#include "alloc_counter.h"
+
+
+
+#if defined(DEBUG_LOG) || defined(ALLOC_COUNTER)
+
+#include <stdlib.h>
+
+
+// provided by the linker because of -Wl,--wrap=...
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t nmemb, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size);
+void* __wrap_calloc(size_t nmemb, size_t size);
+void* __wrap_realloc(void* ptr, size_t size);
+void __wrap_free(void* ptr);
+
+
+static _Thread_local size_t _g_alloc_count = 0; // counted per thread
+
+
+
+void* __wrap_malloc(size_t size)
+{
+    _g_alloc_count++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t nmemb, size_t size)
+{
+    _g_alloc_count++;
+    return __real_calloc(nmemb, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+    _g_alloc_count++;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void* ptr)
+{
+    if(ptr != NULL) {
+        _g_alloc_count++;
+    }
+    __real_free(ptr);
+}
+
+
+
+size_t alloc_counter_get(void)
+{
+    return _g_alloc_count;
+}
+
+#endif
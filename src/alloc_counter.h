@@ -0,0 +1,20 @@
+#ifndef _ALLOC_COUNTER_H
+#define _ALLOC_COUNTER_H
+
+#include <stddef.h>
+
+
+
+// Counts the calls to malloc, calloc, realloc and free made from the solver's own translation units.
+// The count is kept per thread.
+// Only available in builds with -DDEBUG_LOG or -DALLOC_COUNTER (the micro benchmarks), which are linked
+// with -Wl,--wrap=malloc,... (see Makefile). In all other builds, alloc_counter_get() is always 0.
+#if defined(DEBUG_LOG) || defined(ALLOC_COUNTER)
+size_t alloc_counter_get(void);
+#else
+#define alloc_counter_get() ((size_t)0)
+#endif
+
+
+
+#endif
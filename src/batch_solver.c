@@ -0,0 +1,232 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ds_solver.h"
+#include "cli.h"
+#include "sigterm.h"
+#include "scheduler.h"
+#include "solution_writer.h"
+
+
+
+// Solves a list of graph files in one process. Each of the --jobs worker threads owns one DSSolver and
+// takes the next file from a shared counter, so the buffers the solver keeps (see ds_solver_create) are
+// reused from one graph to the next. Each file is solved within --time-limit, or within SCHEDULER_DEFAULT_BUDGET
+// without it.
+// The solution of <dir>/<name> is written to <name>.ds in the output directory, or next to the input if
+// there is none, and a line "<file>\t<size>\t<seconds>" is printed to stdout when it is finished. A file that
+// cannot be solved (e.g. because it is not a valid graph) is reported on stderr and skipped, and the exit
+// status is then EXIT_FAILURE.
+// On SIGTERM, the running solves stop and write their best solution, and the remaining files are skipped.
+
+
+
+#define BATCH_MAX_JOBS 1024
+
+
+
+typedef struct BatchConfig {
+    DSOptions options;
+    double time_limit; // per file, SCHEDULER_DEFAULT_BUDGET by default, so that every file gets its turn
+    const char* output_directory; // NULL to write the solutions next to the inputs
+    char** files;
+    size_t file_count;
+} BatchConfig;
+
+
+typedef struct BatchWorker {
+    pthread_t thread;
+    const BatchConfig* config;
+    atomic_size_t* next_file;    // shared by all workers
+    pthread_mutex_t* print_lock; // shared by all workers
+    bool failed;
+} BatchWorker;
+
+
+
+static void _print_usage(FILE* stream, const char* program_name)
+{
+    fprintf(stream,
+            "Usage: %s [--jobs J] [--output-dir DIR] [solver options] graph.gr...\n"
+            "  --jobs J            solve J files concurrently (default: 1). Each of them uses --threads threads\n"
+            "  --output-dir DIR    write the solutions to DIR instead of next to the input files\n"
+            "  --time-limit (default: %d seconds) and --initial apply to each file separately. The solver\n"
+            "  options are:\n",
+            program_name, (int)SCHEDULER_DEFAULT_BUDGET);
+    cli_print_solver_options(stream);
+    fprintf(stream, "  --help              print this help text\n");
+}
+
+
+
+static BatchConfig _parse_options(int argc, char** argv, unsigned* jobs)
+{
+    BatchConfig config = {.options = ds_default_options(),
+                          .time_limit = SCHEDULER_DEFAULT_BUDGET,
+                          .output_directory = NULL,
+                          .files = NULL,
+                          .file_count = 0};
+    config.options.seed = (uint64_t)time(NULL);
+    *jobs = 1;
+    int i = 1;
+    for(; i < argc && strncmp(argv[i], "--", 2) == 0; i++) {
+        if(cli_parse_solver_option(argc, argv, &i, &config.options, &config.time_limit)) {
+            continue;
+        }
+        if(strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            *jobs = (unsigned)cli_parse_unsigned(argv[i], argv[i + 1], 1, BATCH_MAX_JOBS);
+            i++;
+        }
+        else if(strcmp(argv[i], "--output-dir") == 0 && i + 1 < argc) {
+            config.output_directory = argv[i + 1];
+            i++;
+        }
+        else if(strcmp(argv[i], "--help") == 0) {
+            _print_usage(stdout, argv[0]);
+            exit(EXIT_SUCCESS);
+        }
+        else {
+            fprintf(stderr, "unknown or incomplete option '%s'\n", argv[i]);
+            _print_usage(stderr, argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if(i == argc) {
+        fprintf(stderr, "no input files\n");
+        _print_usage(stderr, argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    config.files = &(argv[i]);
+    config.file_count = (size_t)(argc - i);
+    return config;
+}
+
+
+
+// returns the path of the solution file of input_path. Exits on failure.
+// caller is responsible for freeing the returned string
+static char* _output_path(const char* output_directory, const char* input_path)
+{
+    const char* name = input_path;
+    if(output_directory != NULL) {
+        const char* last_slash = strrchr(input_path, '/');
+        name = last_slash != NULL ? last_slash + 1 : input_path;
+    }
+    const size_t length = (output_directory != NULL ? strlen(output_directory) + 1 : 0) + strlen(name) + 4;
+    char* path = malloc(length);
+    if(!path) {
+        perror("batch_solver: allocating path failed");
+        exit(EXIT_FAILURE);
+    }
+    if(output_directory != NULL) {
+        snprintf(path, length, "%s/%s.ds", output_directory, name);
+    }
+    else {
+        snprintf(path, length, "%s.ds", name);
+    }
+    return path;
+}
+
+
+
+// solve the file and write its solution, returns false if a file could not be opened, solved or written
+static bool _solve_file(DSSolver* solver, const BatchConfig* config, const char* input_path,
+                        pthread_mutex_t* print_lock)
+{
+    FILE* input = fopen(input_path, "r");
+    if(!input) {
+        perror(input_path);
+        return false;
+    }
+    const double start = scheduler_now();
+    const DSResult result = ds_solve(solver, input, &config->options, config->time_limit, sigterm_flag());
+    const double seconds = scheduler_now() - start;
+    fclose(input);
+    if(result.status != DS_STATUS_OK) { // the reason has been printed
+        fprintf(stderr, "%s: skipped, it could not be solved\n", input_path);
+        return false;
+    }
+
+    char* output_path = _output_path(config->output_directory, input_path);
+    const int output = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool success = output >= 0;
+    if(success) {
+        success = solution_write(output, result.ids, result.size);
+        success = (close(output) == 0) && success;
+    }
+    if(!success) {
+        perror(output_path);
+    }
+    free(output_path);
+
+    pthread_mutex_lock(print_lock);
+    printf("%s\t%zu\t%.3f\n", input_path, result.size, seconds);
+    fflush(stdout);
+    pthread_mutex_unlock(print_lock);
+    return success;
+}
+
+
+
+static void* _worker_thread(void* arg)
+{
+    BatchWorker* worker = (BatchWorker*)arg;
+    DSSolver* solver = ds_solver_create();
+    if(!solver) {
+        perror("ds_solver_create failed");
+        exit(EXIT_FAILURE);
+    }
+    while(!atomic_load(sigterm_flag())) {
+        const size_t file_idx = atomic_fetch_add(worker->next_file, 1);
+        if(file_idx >= worker->config->file_count) {
+            break;
+        }
+        if(!_solve_file(solver, worker->config, worker->config->files[file_idx], worker->print_lock)) {
+            worker->failed = true;
+        }
+    }
+    ds_solver_free(solver);
+    return NULL;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned jobs;
+    BatchConfig config = _parse_options(argc, argv, &jobs);
+    sigterm_register_handler();
+    if(jobs > config.file_count) {
+        jobs = (unsigned)config.file_count;
+    }
+
+    atomic_size_t next_file;
+    atomic_init(&next_file, 0);
+    pthread_mutex_t print_lock = PTHREAD_MUTEX_INITIALIZER;
+    BatchWorker* workers = calloc(jobs, sizeof(BatchWorker));
+    if(!workers) {
+        perror("batch_solver: allocating workers failed");
+        exit(EXIT_FAILURE);
+    }
+    for(unsigned t = 0; t < jobs; t++) {
+        workers[t] = (BatchWorker){.config = &config, .next_file = &next_file, .print_lock = &print_lock, .failed = false};
+        if(pthread_create(&(workers[t].thread), NULL, _worker_thread, &(workers[t])) != 0) {
+            perror("batch_solver: pthread_create failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    bool failed = false;
+    for(unsigned t = 0; t < jobs; t++) {
+        pthread_join(workers[t].thread, NULL);
+        failed = failed || workers[t].failed;
+    }
+    free(workers);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,408 @@
+#include "cc_solver.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "fast_random.h"
+#include "debug_log.h"
+#include "alloc_counter.h"
+
+
+
+#define CC_BMS_SAMPLES          50 // the vertex to remove is the best of x random ds vertices
+#define CC_TABU_TENURE          3 // an added vertex must not be removed for x steps
+#define CC_WEIGHT_AVERAGE_LIMIT 300 // when the average weight exceeds x, all weights are scaled down
+#define CC_WEIGHT_FORGET_FACTOR 0.3
+#define CC_NO_VERTEX            UINT32_MAX
+#define CC_STOP_CHECK_INTERVAL  64 // check for a stop request every x steps, a step takes much less time than reading the clock
+
+
+
+// A set of vertices that supports insertion, removal and choosing a random element in O(1)
+typedef struct VertexList {
+    uint32_t* elems;
+    uint32_t* pos; // the index of each contained vertex in elems
+    uint32_t size;
+} VertexList;
+
+
+
+typedef struct CCSearch {
+    const Kernel* k;
+    /*  The score of a ds vertex is minus the total weight of the vertices that would become undominated if it
+        was removed. The score of any other vertex is the total weight of the undominated vertices that would
+        become dominated if it was added. */
+    int64_t* score;
+    uint32_t* weight;              // the weight of each vertex, increased while it is undominated
+    uint64_t total_weight;         // the sum of all weights
+    uint32_t* dominated_by_number; // the number of vertices in the closed neighborhood in the ds, including fixed ones
+    /*  For each vertex the xor of the indices of all ds vertices in its closed neighborhood. If a vertex
+        is dominated by exactly one ds vertex and no fixed vertex, this is the index of that ds vertex. */
+    uint32_t* dominator_xor;
+    bool* is_in_ds;
+    bool* conf_changed;   // configuration checking: false if no neighbor was added or removed since the vertex was removed
+    uint64_t* last_moved; // the step in which the vertex was last added or removed, to prefer older vertices
+    uint64_t* tabu_until; // the step until which the vertex must not be removed
+    VertexList ds;
+    VertexList undominated;
+    uint64_t step;
+    fast_random_t rng;
+} CCSearch;
+
+
+
+static uint32_t _random_index(fast_random_t* rng, uint32_t bound)
+{
+    return (uint32_t)(((__uint128_t)bound * (__uint128_t)fast_random(rng)) / ((__uint128_t)FAST_RANDOM_MAX + 1));
+}
+
+
+
+static inline void _list_insert(VertexList* l, uint32_t v)
+{
+    l->pos[v] = l->size;
+    l->elems[l->size++] = v;
+}
+
+
+
+static inline void _list_remove(VertexList* l, uint32_t v)
+{
+    uint32_t last = l->elems[--(l->size)];
+    l->elems[l->pos[v]] = last;
+    l->pos[last] = l->pos[v];
+}
+
+
+
+// (the analyzer cannot tell that the arrays of the lists do not alias and reports false leaks)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wanalyzer-malloc-leak"
+static void _cc_init(CCSearch* cc, const Kernel* k, uint64_t seed)
+{
+    const size_t n = (size_t)k->n + 1; // + 1 to avoid malloc(0)
+    cc->k = k;
+    cc->score = malloc(n * sizeof(int64_t));
+    cc->weight = malloc(n * sizeof(uint32_t));
+    cc->dominated_by_number = malloc(n * sizeof(uint32_t));
+    cc->dominator_xor = malloc(n * sizeof(uint32_t));
+    cc->is_in_ds = malloc(n * sizeof(bool));
+    cc->conf_changed = malloc(n * sizeof(bool));
+    cc->last_moved = calloc(n, sizeof(uint64_t));
+    cc->tabu_until = calloc(n, sizeof(uint64_t));
+    cc->ds.elems = malloc(n * sizeof(uint32_t));
+    cc->ds.pos = malloc(n * sizeof(uint32_t));
+    cc->undominated.elems = malloc(n * sizeof(uint32_t));
+    cc->undominated.pos = malloc(n * sizeof(uint32_t));
+    if(!cc->score || !cc->weight || !cc->dominated_by_number || !cc->dominator_xor || !cc->is_in_ds ||
+       !cc->conf_changed || !cc->last_moved || !cc->tabu_until || !cc->ds.elems || !cc->ds.pos ||
+       !cc->undominated.elems || !cc->undominated.pos) {
+        perror("cc_solver: malloc failed");
+        exit(EXIT_FAILURE);
+    }
+    cc->ds.size = 0;
+    cc->undominated.size = 0;
+    cc->step = 0;
+    fast_random_init(&cc->rng, seed);
+    for(uint32_t v = 0; v < k->n; v++) {
+        cc->weight[v] = 1;
+        cc->conf_changed[v] = true;
+    }
+    cc->total_weight = k->n;
+}
+#pragma GCC diagnostic pop
+
+
+
+static void _cc_free(CCSearch* cc)
+{
+    free(cc->score);
+    free(cc->weight);
+    free(cc->dominated_by_number);
+    free(cc->dominator_xor);
+    free(cc->is_in_ds);
+    free(cc->conf_changed);
+    free(cc->last_moved);
+    free(cc->tabu_until);
+    free(cc->ds.elems);
+    free(cc->ds.pos);
+    free(cc->undominated.elems);
+    free(cc->undominated.pos);
+}
+
+
+
+// x is private if exactly one ds vertex and no fixed vertex dominates it, i.e. removing that ds vertex undominates x
+static inline bool _is_private(const CCSearch* cc, uint32_t x)
+{
+    return cc->dominated_by_number[x] == 1 && cc->k->dominated_by_fixed[x] == 0;
+}
+
+
+
+// compute the domination counts of the solution in cc->is_in_ds and all scores from scratch
+static void _cc_compute_scores(CCSearch* cc)
+{
+    const Kernel* k = cc->k;
+    cc->ds.size = 0;
+    cc->undominated.size = 0;
+    for(uint32_t v = 0; v < k->n; v++) {
+        cc->dominated_by_number[v] = k->dominated_by_fixed[v];
+        cc->dominator_xor[v] = 0;
+        cc->score[v] = 0;
+    }
+    for(uint32_t v = 0; v < k->n; v++) {
+        if(cc->is_in_ds[v]) {
+            _list_insert(&cc->ds, v);
+            cc->dominated_by_number[v]++;
+            cc->dominator_xor[v] ^= v;
+            uint32_t u;
+            for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+                cc->dominated_by_number[u]++;
+                cc->dominator_xor[u] ^= v;
+            }
+        }
+    }
+    for(uint32_t x = 0; x < k->n; x++) {
+        if(_is_private(cc, x)) {
+            cc->score[cc->dominator_xor[x]] -= cc->weight[x];
+        }
+        else if(cc->dominated_by_number[x] == 0) {
+            _list_insert(&cc->undominated, x);
+            cc->score[x] += cc->weight[x];
+            uint32_t u;
+            for(KernelNeighbors it = kernel_neighbors(k, x); kernel_next_neighbor(&it, &u);) {
+                cc->score[u] += cc->weight[x];
+            }
+        }
+    }
+}
+
+
+
+// add delta to the scores of all vertices in the closed neighborhood of x except v
+static inline void _cc_add_to_neighbor_scores(CCSearch* cc, uint32_t x, uint32_t v, int64_t delta)
+{
+    const Kernel* k = cc->k;
+    if(x != v) {
+        cc->score[x] += delta;
+    }
+    uint32_t y;
+    for(KernelNeighbors it = kernel_neighbors(k, x); kernel_next_neighbor(&it, &y);) {
+        if(y != v) {
+            cc->score[y] += delta;
+        }
+    }
+}
+
+
+
+// update x, a vertex in the closed neighborhood of v, after v has been added to the ds. The score of v is
+// updated by the caller.
+static inline void _cc_dominate(CCSearch* cc, uint32_t x, uint32_t v)
+{
+    cc->dominated_by_number[x]++;
+    cc->dominator_xor[x] ^= v;
+    if(cc->dominated_by_number[x] == 1) { // x was undominated and is now private to v
+        _list_remove(&cc->undominated, x);
+        _cc_add_to_neighbor_scores(cc, x, v, -(int64_t)cc->weight[x]);
+    }
+    else if(cc->dominated_by_number[x] == 2 && cc->k->dominated_by_fixed[x] == 0) { // x is no longer private to its other dominator
+        cc->score[cc->dominator_xor[x] ^ v] += cc->weight[x];
+    }
+}
+
+
+
+// update x, a vertex in the closed neighborhood of v, after v has been removed from the ds. The score of v
+// is updated by the caller.
+static inline void _cc_undominate(CCSearch* cc, uint32_t x, uint32_t v)
+{
+    cc->dominated_by_number[x]--;
+    cc->dominator_xor[x] ^= v;
+    if(cc->dominated_by_number[x] == 0) { // x was private to v and is now undominated
+        _list_insert(&cc->undominated, x);
+        _cc_add_to_neighbor_scores(cc, x, v, cc->weight[x]);
+    }
+    else if(_is_private(cc, x)) { // x is now private to its remaining dominator
+        cc->score[cc->dominator_xor[x]] -= cc->weight[x];
+    }
+}
+
+
+
+static void _cc_add(CCSearch* cc, uint32_t v)
+{
+    assert(!cc->is_in_ds[v]);
+    const Kernel* k = cc->k;
+    cc->is_in_ds[v] = true;
+    _list_insert(&cc->ds, v);
+    _cc_dominate(cc, v, v);
+    uint32_t u;
+    for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+        _cc_dominate(cc, u, v);
+        cc->conf_changed[u] = true;
+    }
+    // the vertices v dominates now privately are exactly those that were undominated before
+    cc->score[v] = -cc->score[v];
+    cc->last_moved[v] = cc->step;
+    cc->tabu_until[v] = cc->step + CC_TABU_TENURE;
+}
+
+
+
+static void _cc_remove(CCSearch* cc, uint32_t v)
+{
+    assert(cc->is_in_ds[v]);
+    const Kernel* k = cc->k;
+    cc->is_in_ds[v] = false;
+    _list_remove(&cc->ds, v);
+    _cc_undominate(cc, v, v);
+    uint32_t u;
+    for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+        _cc_undominate(cc, u, v);
+        cc->conf_changed[u] = true;
+    }
+    // the vertices v would dominate if it was added again are exactly those it dominated privately before
+    cc->score[v] = -cc->score[v];
+    cc->conf_changed[v] = false;
+    cc->last_moved[v] = cc->step;
+}
+
+
+
+// whether u is a better choice than v (which may be CC_NO_VERTEX), i.e. has a higher score or is older
+static inline bool _cc_is_better(const CCSearch* cc, uint32_t u, uint32_t v)
+{
+    return v == CC_NO_VERTEX || cc->score[u] > cc->score[v] ||
+           (cc->score[u] == cc->score[v] && cc->last_moved[u] < cc->last_moved[v]);
+}
+
+
+
+// choose the ds vertex to remove: the best of CC_BMS_SAMPLES random ds vertices that are not tabu, or the
+// best of all samples if all are tabu. The ds must not be empty.
+static uint32_t _cc_choose_removal(CCSearch* cc)
+{
+    assert(cc->ds.size > 0);
+    uint32_t best = CC_NO_VERTEX;
+    uint32_t best_tabu = CC_NO_VERTEX;
+    for(unsigned sample = 0; sample < CC_BMS_SAMPLES; sample++) {
+        uint32_t u = cc->ds.elems[_random_index(&cc->rng, cc->ds.size)];
+        if(cc->tabu_until[u] > cc->step) {
+            best_tabu = _cc_is_better(cc, u, best_tabu) ? u : best_tabu;
+        }
+        else {
+            best = _cc_is_better(cc, u, best) ? u : best;
+        }
+    }
+    return best != CC_NO_VERTEX ? best : best_tabu;
+}
+
+
+
+// choose the vertex to add: the best vertex in the closed neighborhood of a random undominated vertex whose
+// configuration has changed, or the best of all of them if there is none. There must be an undominated vertex.
+static uint32_t _cc_choose_addition(CCSearch* cc)
+{
+    assert(cc->undominated.size > 0);
+    const Kernel* k = cc->k;
+    uint32_t x = cc->undominated.elems[_random_index(&cc->rng, cc->undominated.size)];
+    uint32_t best = cc->conf_changed[x] ? x : CC_NO_VERTEX;
+    uint32_t best_ignoring_conf = x;
+    uint32_t w; // none of the neighbors is in the ds because x is undominated
+    for(KernelNeighbors it = kernel_neighbors(k, x); kernel_next_neighbor(&it, &w);) {
+        if(cc->conf_changed[w] && _cc_is_better(cc, w, best)) {
+            best = w;
+        }
+        if(_cc_is_better(cc, w, best_ignoring_conf)) {
+            best_ignoring_conf = w;
+        }
+    }
+    return best != CC_NO_VERTEX ? best : best_ignoring_conf;
+}
+
+
+
+// increase the weight of every undominated vertex by one. If the average weight gets too high, all weights
+// are scaled down, so that the search can forget old weights.
+static void _cc_update_weights(CCSearch* cc)
+{
+    const Kernel* k = cc->k;
+    for(uint32_t i = 0; i < cc->undominated.size; i++) {
+        uint32_t x = cc->undominated.elems[i];
+        cc->weight[x]++;
+        _cc_add_to_neighbor_scores(cc, x, CC_NO_VERTEX, 1);
+    }
+    cc->total_weight += cc->undominated.size;
+    if(cc->total_weight > (uint64_t)CC_WEIGHT_AVERAGE_LIMIT * k->n) {
+        cc->total_weight = 0;
+        for(uint32_t v = 0; v < k->n; v++) {
+            uint32_t scaled = (uint32_t)(CC_WEIGHT_FORGET_FACTOR * cc->weight[v]);
+            cc->weight[v] = scaled > 1 ? scaled : 1;
+            cc->total_weight += cc->weight[v];
+        }
+        _cc_compute_scores(cc);
+    }
+}
+
+
+
+// Runs the search on the kernel until a stop is requested. seed initializes the random number generator.
+// in_ds must contain a dominating set of k with ds_size vertices, for example the result of
+// greedy_initial_solution or iterated_greedy_solver, which the search starts from. It is overwritten with
+// the best dominating set found, which is never larger. stats receives the improvements over time and the
+// number of steps, and may be NULL.
+// returns the number of vertices in the dominating set.
+size_t cc_solver(const Kernel* k, const StopCondition* stop, uint64_t seed, bool* in_ds, size_t ds_size,
+                 SolveStats* stats)
+{
+    assert(k != NULL && in_ds != NULL);
+    CCSearch cc;
+    _cc_init(&cc, k, seed);
+    memcpy(cc.is_in_ds, in_ds, (size_t)k->n * sizeof(bool));
+    _cc_compute_scores(&cc);
+    assert(cc.ds.size == ds_size && cc.undominated.size == 0);
+    size_t best_ds_size = ds_size;
+
+#ifdef DEBUG_LOG
+    const size_t allocations_before_search = alloc_counter_get();
+#endif
+    while(cc.step % CC_STOP_CHECK_INTERVAL != 0 || !stop_requested(stop)) {
+        cc.step++;
+        if(cc.undominated.size == 0) {
+            if(cc.ds.size < best_ds_size) {
+                best_ds_size = cc.ds.size;
+                memcpy(in_ds, cc.is_in_ds, (size_t)k->n * sizeof(bool));
+                if(stats != NULL) {
+                    solve_stats_record_progress(stats, best_ds_size + k->fixed_count, cc.step, "cc");
+                }
+                debug_log("cc_solver: IMPROVEMENT: ds size == %zu in step %" PRIu64 "\n", best_ds_size, cc.step);
+            }
+            if(cc.ds.size == 0) {
+                break;
+            }
+            _cc_remove(&cc, _cc_choose_removal(&cc));
+        }
+        else {
+            _cc_add(&cc, _cc_choose_addition(&cc));
+            _cc_update_weights(&cc);
+        }
+    }
+#ifdef DEBUG_LOG
+    const size_t allocations_in_search = alloc_counter_get() - allocations_before_search;
+    debug_log("heap allocations and frees in cc_solver search == %zu\n", allocations_in_search);
+    assert(allocations_in_search == 0);
+#endif
+
+    if(stats != NULL) {
+        stats->search_iterations = cc.step;
+    }
+    fprintf(stderr, "final ds size == %zu\t\tds + fixed == %zu\t\tcc steps == %" PRIu64 "\n", best_ds_size,
+            best_ds_size + k->fixed_count, cc.step);
+    fflush(stderr);
+    _cc_free(&cc);
+    return best_ds_size;
+}
@@ -0,0 +1,34 @@
+#ifndef _CC_SOLVER_H
+#define _CC_SOLVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "kernel.h"
+#include "scheduler.h"
+#include "solve_stats.h"
+
+
+
+// Configuration checking local search, an alternative to the iterated greedy solver.
+// Whenever the current solution is a dominating set, it is saved if it is the best one so far, and the ds
+// vertex whose removal undominates the least weight is removed. Otherwise, the best vertex that dominates a
+// random undominated vertex is added, and the weights of all vertices that stay undominated are increased,
+// so that vertices that are hard to dominate get more and more important.
+// Configuration checking: a removed vertex may only be added again after one of its neighbors has been
+// added or removed, which prevents most cycles. Added vertices are also tabu for removal for a few steps.
+
+
+
+// Runs the search on the kernel until a stop is requested. seed initializes the random number generator.
+// in_ds must contain a dominating set of k with ds_size vertices, for example the result of
+// greedy_initial_solution or iterated_greedy_solver, which the search starts from. It is overwritten with
+// the best dominating set found, which is never larger. stats receives the improvements over time and the
+// number of steps, and may be NULL.
+// returns the number of vertices in the dominating set.
+size_t cc_solver(const Kernel* k, const StopCondition* stop, uint64_t seed, bool* in_ds, size_t ds_size,
+                 SolveStats* stats);
+
+
+
+#endif
@@ -0,0 +1,124 @@
+#include "cli.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "scheduler.h"
+
+
+
+// parse an unsigned integer option argument, exits with an error message if arg is not valid
+unsigned long cli_parse_unsigned(const char* option, const char* arg, unsigned long min, unsigned long max)
+{
+    char* end = NULL;
+    errno = 0;
+    unsigned long value = strtoul(arg, &end, 10);
+    if(errno != 0 || end == arg || *end != '\0' || arg[0] == '-' || value < min || value > max) {
+        fprintf(stderr, "invalid argument for %s: '%s' (must be an integer in [%lu, %lu])\n", option, arg, min, max);
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+
+
+// parse a positive number of seconds, exits with an error message if arg is not valid
+double cli_parse_seconds(const char* option, const char* arg)
+{
+    char* end = NULL;
+    errno = 0;
+    double value = strtod(arg, &end);
+    if(errno != 0 || end == arg || *end != '\0' || !(value > 0.0 && value < 1.e9)) {
+        fprintf(stderr, "invalid argument for %s: '%s' (must be a positive number of seconds)\n", option, arg);
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+
+
+// if argv[*i] is a solver option, parse it (and its argument, then *i is incremented) into options and
+// time_limit and return true. Exits with an error message if the argument is not valid.
+bool cli_parse_solver_option(int argc, char** argv, int* i, DSOptions* options, double* time_limit)
+{
+    const char* option = argv[*i];
+    const char* arg = *i + 1 < argc ? argv[*i + 1] : NULL;
+    if(strcmp(option, "--partition") == 0) {
+        options->ig_config.parallel_mode = IG_PARALLEL_PARTITION;
+        return true;
+    }
+    if(strcmp(option, "--consensus") == 0) {
+        options->ig_config.consensus = true;
+        return true;
+    }
+    if(strcmp(option, "--compact") == 0) {
+        options->compact = true;
+        return true;
+    }
+    if(arg == NULL) {
+        return false;
+    }
+    if(strcmp(option, "--time-limit") == 0) {
+        *time_limit = cli_parse_seconds(option, arg);
+    }
+    else if(strcmp(option, "--initial") == 0) {
+        options->initial_solution_path = arg;
+    }
+    else if(strcmp(option, "--cache") == 0) {
+        options->cache_directory = arg;
+    }
+    else if(strcmp(option, "--export-kernel") == 0) {
+        options->export_kernel_path = arg;
+    }
+    else if(strcmp(option, "--engine") == 0 && strcmp(arg, "ig") == 0) {
+        options->engine = DS_ENGINE_IG;
+    }
+    else if(strcmp(option, "--engine") == 0 && strcmp(arg, "cc") == 0) {
+        options->engine = DS_ENGINE_CC;
+    }
+    else if(strcmp(option, "--threads") == 0) {
+        options->ig_config.num_threads = (unsigned)cli_parse_unsigned(option, arg, 1, 1024);
+    }
+    else if(strcmp(option, "--local-search") == 0) {
+        options->ig_config.local_search_interval = cli_parse_unsigned(option, arg, 0, 1000000000);
+    }
+    else if(strcmp(option, "--seed") == 0) {
+        options->seed = cli_parse_unsigned(option, arg, 0, ULONG_MAX);
+    }
+    else {
+        return false;
+    }
+    (*i)++;
+    return true;
+}
+
+
+
+// print the help text of the solver options
+void cli_print_solver_options(FILE* stream)
+{
+    fprintf(stream,
+            "  --time-limit S      stop after S seconds of wall clock time, as if a SIGTERM was received. The\n"
+            "                      phases are scheduled for this budget (default: %d seconds)\n"
+            "  --initial FILE      start the search from the solution in FILE (PACE format), for example the\n"
+            "                      result of a previous run. It is completed greedily if it is not dominating\n"
+            "  --cache DIR         store the kernel of the input in DIR, and load it from there instead of\n"
+            "                      parsing and reducing the graph when the same input is solved again\n"
+            "  --export-kernel FILE  write the kernel to FILE as a graph in PACE format, see kernel.h\n"
+            "  --compact           save memory on very large graphs: parse the input directly into the kernel,\n"
+            "                      without the reduction and without --cache (see make compressed)\n"
+            "  --seed X            seed of the random number generators (default: the current time)\n"
+            "  --engine ig|cc      the solver to run after the reduction: ig for iterated greedy (default) or cc\n"
+            "                      for configuration checking local search. The following options only apply to ig.\n"
+            "  --threads K         run K iterated greedy workers in parallel (default: 1)\n"
+            "  --partition         let the threads improve disjoint parts of one shared solution instead\n"
+            "                      of searching independently, for very large graphs\n"
+            "  --local-search K    start with a swap based local search phase every K greedy iterations, the\n"
+            "                      interval then adapts to the improvement rates. 0 to disable (default: %d,\n"
+            "                      not used by --partition)\n"
+            "  --consensus         fix the vertices that are in all or in none of a worker's recent best solutions,\n"
+            "                      and search only on the rest until the search stalls (not used by --partition)\n",
+            (int)SCHEDULER_DEFAULT_BUDGET, DS_DEFAULT_LOCAL_SEARCH_INTERVAL);
+}
@@ -0,0 +1,36 @@
+#ifndef _CLI_H
+#define _CLI_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "ds_solver.h"
+
+
+
+// Command line options that are shared by the executables.
+
+
+
+// parse an unsigned integer option argument, exits with an error message if arg is not valid
+unsigned long cli_parse_unsigned(const char* option, const char* arg, unsigned long min, unsigned long max);
+
+
+
+// parse a positive number of seconds, exits with an error message if arg is not valid
+double cli_parse_seconds(const char* option, const char* arg);
+
+
+
+// if argv[*i] is a solver option, parse it (and its argument, then *i is incremented) into options and
+// time_limit and return true. Exits with an error message if the argument is not valid.
+bool cli_parse_solver_option(int argc, char** argv, int* i, DSOptions* options, double* time_limit);
+
+
+
+// print the help text of the solver options
+void cli_print_solver_options(FILE* stream);
+
+
+
+#endif
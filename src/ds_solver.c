@@ -0,0 +1,492 @@
+#include "ds_solver.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <float.h>
+#include <errno.h>
+
+#include "graph.h"
+#include "kernel.h"
+#include "kernel_cache.h"
+#include "reduction.h"
+#include "cc_solver.h"
+#include "scheduler.h"
+#include "perf_counters.h"
+#include "debug_log.h"
+
+
+
+struct DSSolver {
+    uint32_t* result_ids;     // the buffer of the last result, reused by the next solve
+    size_t result_capacity;
+    bool* in_ds;              // the solution of the search on the kernel, reused by the next solve
+    bool* initial_ds;         // the warm start of the search on the kernel, reused by the next solve
+    size_t solution_capacity; // the length of in_ds and initial_ds
+    atomic_bool never_set;    // the stop flag of solves without one
+    SolveStats stats;         // of the last solve
+    Graph* interrupted_graph; // the graph of an interrupted solve, freed only after its result has been used
+    Trace trace;              // of the last solve, if it was recorded
+};
+
+
+
+// the default options: iterated greedy with one thread, seed 0, no files
+DSOptions ds_default_options(void)
+{
+    DSOptions options = {.engine = DS_ENGINE_IG,
+                         .ig_config = {.num_threads = 1,
+                                       .parallel_mode = IG_PARALLEL_PORTFOLIO,
+                                       .local_search_interval = DS_DEFAULT_LOCAL_SEARCH_INTERVAL,
+                                       .consensus = false,
+                                       .seed = 0,
+                                       .initial_ds = NULL,
+                                       .stats = NULL},
+                         .seed = 0,
+                         .initial_solution_path = NULL,
+                         .cache_directory = NULL,
+                         .export_kernel_path = NULL,
+                         .record_trace = false,
+                         .compact = false};
+    return options;
+}
+
+
+
+// ds_solver_create may return NULL if not successful. The returned value has to be freed using
+// ds_solver_free(...). A solver can solve any number of graphs one after another. It keeps the result buffer
+// and the solution arrays of the search, which only grow, while the graph, the kernel and the search state
+// are allocated for each solve. Only the graph of an interrupted solve is kept until the next solve or
+// ds_solver_free, so that the result is available without waiting for it to be freed.
+DSSolver* ds_solver_create(void)
+{
+    DSSolver* solver = calloc(1, sizeof(DSSolver));
+    if(!solver) {
+        return NULL;
+    }
+    atomic_init(&solver->never_set, false);
+    trace_init(&solver->trace, 0.0);
+    return solver;
+}
+
+
+
+void ds_solver_free(DSSolver* solver)
+{
+    if(solver != NULL) {
+        if(solver->interrupted_graph != NULL) {
+            graph_free(solver->interrupted_graph);
+        }
+        free(solver->result_ids);
+        free(solver->in_ds);
+        free(solver->initial_ds);
+        trace_free(&solver->trace);
+        free(solver);
+    }
+}
+
+
+
+// the result of a failed solve
+static DSResult _error_result(DSStatus status)
+{
+    const DSResult result = {.ids = NULL, .size = 0, .status = status};
+    return result;
+}
+
+
+
+// make sure the result buffer has space for capacity ids, returns false if the allocation failed
+static bool _reserve_result(DSSolver* solver, size_t capacity)
+{
+    if(capacity > solver->result_capacity) {
+        uint32_t* ids = realloc(solver->result_ids, capacity * sizeof(uint32_t));
+        if(!ids) {
+            perror("ds_solve: allocating result buffer failed");
+            return false;
+        }
+        solver->result_ids = ids;
+        solver->result_capacity = capacity;
+    }
+    return true;
+}
+
+
+
+// make sure in_ds and initial_ds have space for n vertices, returns false if an allocation failed
+static bool _reserve_solution(DSSolver* solver, size_t n)
+{
+    if(n > solver->solution_capacity) {
+        free(solver->in_ds);
+        free(solver->initial_ds);
+        solver->in_ds = malloc(n * sizeof(bool));
+        solver->initial_ds = malloc(n * sizeof(bool));
+        solver->solution_capacity = solver->in_ds != NULL && solver->initial_ds != NULL ? n : 0;
+        if(solver->solution_capacity == 0) {
+            perror("ds_solve: allocating solution arrays failed");
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+// the result consists of the fixed vertices of k and all vertices v with in_ds[v] (in_ds may be NULL if ds_size == 0)
+static DSResult _kernel_result(DSSolver* solver, const Kernel* k, const bool* in_ds, size_t ds_size)
+{
+    assert(k != NULL && (in_ds != NULL || ds_size == 0));
+    if(!_reserve_result(solver, k->fixed_count + ds_size + 1)) {
+        return _error_result(DS_STATUS_OUT_OF_MEMORY);
+    }
+    DSResult result = {.ids = solver->result_ids, .size = 0, .status = DS_STATUS_OK};
+    for(size_t fixed_idx = 0; fixed_idx < k->fixed_count; fixed_idx++) {
+        solver->result_ids[result.size++] = k->fixed_ids[fixed_idx];
+    }
+    for(uint32_t v = 0; in_ds != NULL && v < k->n; v++) {
+        if(in_ds[v]) {
+            solver->result_ids[result.size++] = k->ids[v];
+        }
+    }
+    assert(result.size == k->fixed_count + ds_size);
+    return result;
+}
+
+
+
+// the result is the streaming ds, which is built while parsing and is valid even if the graph is incomplete
+static DSResult _streaming_result(DSSolver* solver, const bool* streaming_ds_by_id, uint32_t id_max,
+                                  size_t ds_size)
+{
+    if(!_reserve_result(solver, ds_size + 1)) {
+        return _error_result(DS_STATUS_OUT_OF_MEMORY);
+    }
+    DSResult result = {.ids = solver->result_ids, .size = 0, .status = DS_STATUS_OK};
+    for(uint32_t id = 1; id <= id_max; id++) {
+        if(streaming_ds_by_id[id]) {
+            solver->result_ids[result.size++] = id;
+        }
+    }
+    assert(result.size == ds_size);
+    return result;
+}
+
+
+
+// keep g until the next solve or ds_solver_free: freeing a large graph takes a noticeable time, and when the
+// solve is interrupted, the result should be available as soon as possible
+static void _defer_graph_free(DSSolver* solver, Graph* g)
+{
+    assert(solver->interrupted_graph == NULL);
+    solver->interrupted_graph = g;
+}
+
+
+
+// record the end of a phase in the trace, if there is one. ds_size is the size of the best known solution.
+static void _trace_phase(SolveStats* stats, const char* phase, size_t ds_size)
+{
+    if(stats->trace != NULL) {
+        trace_record(stats->trace, phase, 0, ds_size);
+    }
+}
+
+
+
+// parse the graph from input, reduce it and build its kernel. *streaming_ds_by_id is set to the streaming ds
+// (indexed by vertex id, to be freed by the caller).
+// If the graph is incomplete or a stop is requested during the reduction, the streaming ds is stored in
+// *fallback instead, and NULL is returned. If it
+// cannot be parsed or its kernel cannot be built, *fallback is the error result and NULL is returned.
+static Kernel* _reduce_input(DSSolver* solver, FILE* input, Scheduler* sch, const StopCondition* stop,
+                             bool** streaming_ds_by_id, DSResult* fallback)
+{
+    SolveStats* stats = &solver->stats;
+    const double parse_start = scheduler_now();
+    perf_phase_begin(PERF_PHASE_PARSE);
+    Graph* g = graph_parse(input, stop);
+    perf_phase_end(PERF_PHASE_PARSE);
+    if(!g) {
+        *fallback = _error_result(errno == ENOMEM ? DS_STATUS_OUT_OF_MEMORY : DS_STATUS_INVALID_INPUT);
+        return NULL;
+    }
+    const double reduction_start = scheduler_now();
+    stats->parse_seconds += reduction_start - parse_start;
+    stats->input_n = g->n;
+    stats->input_m = g->m;
+    _trace_phase(stats, "parse", g->streaming_ds_size);
+    debug_log("streaming ds size == %" PRIu32 "\n", g->streaming_ds_size);
+    if(g->is_incomplete) { // there was no time to read the edges
+        stats->is_incomplete = true;
+        *fallback = _streaming_result(solver, g->in_streaming_ds, g->id_max, g->streaming_ds_size);
+        _defer_graph_free(solver, g);
+        return NULL;
+    }
+
+    debug_log("starting reduction with g->n == %" PRIu32 ", g->m == %" PRIu64 "\n", g->n, g->m);
+    stats->is_reduction_complete = reduce(g, sch, stop, stats->reduction_rules);
+    debug_log("finished reduction with g->n == %" PRIu32 ", g->m == %" PRIu64 ", g->fixed.size == %zu, %.2f s left\n",
+              g->n, g->m, g->fixed.size, scheduler_remaining(sch));
+    if(stop_requested(stop)) { // there is no time to build the kernel and to search
+        *fallback = _streaming_result(solver, g->in_streaming_ds, g->id_max, g->streaming_ds_size);
+        _defer_graph_free(solver, g);
+        return NULL;
+    }
+
+    if(g->n <= 3) {
+        if(g->n != 0) { // although extremely unlikely, it is possible that the whole graph can be reduced but the time budget ran out just before the last reduction step
+            stats->is_reduction_complete = reduce(g, sch, stop, stats->reduction_rules);
+        }
+        stats->is_reduction_complete |= g->n == 0;
+    }
+
+    // from here on, only the compact kernel is needed
+    Kernel* k = kernel_from_graph(g);
+    if(!k) {
+        perror("kernel_from_graph failed");
+        graph_free(g);
+        *fallback = _error_result(DS_STATUS_OUT_OF_MEMORY);
+        return NULL;
+    }
+    *streaming_ds_by_id = g->in_streaming_ds;
+    g->in_streaming_ds = NULL;
+    _trace_phase(stats, "reduction", g->streaming_ds_size);
+    graph_free(g);
+    stats->reduction_seconds = scheduler_now() - reduction_start;
+    return k;
+}
+
+
+
+// parse the graph from input directly into a kernel without reducing it, see kernel_parse. The streaming ds and
+// the fallback are handled like in _reduce_input.
+static Kernel* _parse_compact(DSSolver* solver, FILE* input, const StopCondition* stop, bool** streaming_ds_by_id,
+                              DSResult* fallback)
+{
+    SolveStats* stats = &solver->stats;
+    const double parse_start = scheduler_now();
+    perf_phase_begin(PERF_PHASE_PARSE);
+    uint32_t id_max;
+    Kernel* k = kernel_parse(input, stop, streaming_ds_by_id, &id_max);
+    perf_phase_end(PERF_PHASE_PARSE);
+    if(*streaming_ds_by_id == NULL) {
+        *fallback = _error_result(errno == ENOMEM ? DS_STATUS_OUT_OF_MEMORY : DS_STATUS_INVALID_INPUT);
+        return NULL;
+    }
+    stats->parse_seconds += scheduler_now() - parse_start;
+    stats->input_n = id_max;
+    stats->input_m = k != NULL ? k->m : 0;
+    size_t streaming_ds_size = 0;
+    for(uint32_t id = 1; id <= id_max; id++) {
+        streaming_ds_size += (*streaming_ds_by_id)[id];
+    }
+    _trace_phase(stats, "parse", streaming_ds_size);
+    debug_log("streaming ds size == %zu\n", streaming_ds_size);
+    if(!k || stop_requested(stop)) { // there is no time to build the kernel or to search
+        stats->is_incomplete = k == NULL;
+        *fallback = _streaming_result(solver, *streaming_ds_by_id, id_max, streaming_ds_size);
+        free(*streaming_ds_by_id);
+        *streaming_ds_by_id = NULL;
+        if(k != NULL) {
+            kernel_free(k);
+        }
+        return NULL;
+    }
+    return k;
+}
+
+
+
+// get the kernel of the graph in file, from the kernel cache if possible, see kernel_cache.h.
+// *streaming_ds_by_id is set to the streaming ds of the graph, or to NULL if the kernel was loaded.
+// Returns NULL if the graph could not be parsed completely or not at all, then *fallback is the result.
+static Kernel* _load_kernel(DSSolver* solver, FILE* file, const DSOptions* options, Scheduler* sch,
+                            const StopCondition* stop, bool** streaming_ds_by_id, DSResult* fallback)
+{
+    *streaming_ds_by_id = NULL;
+    if(options->compact) {
+        return _parse_compact(solver, file, stop, streaming_ds_by_id, fallback);
+    }
+    if(options->cache_directory == NULL) {
+        return _reduce_input(solver, file, sch, stop, streaming_ds_by_id, fallback);
+    }
+    const double read_start = scheduler_now();
+    InputBuffer input = kernel_cache_read_input(file);
+    if(!input.data) { // the reason has been printed
+        *fallback = _error_result(errno == ENOMEM ? DS_STATUS_OUT_OF_MEMORY : DS_STATUS_INVALID_INPUT);
+        return NULL;
+    }
+    const double load_start = scheduler_now();
+    solver->stats.parse_seconds = load_start - read_start;
+    _trace_phase(&solver->stats, "read", 0);
+    Kernel* k = kernel_cache_load(options->cache_directory, &input);
+    if(k != NULL) {
+        _trace_phase(&solver->stats, "reduction", 0);
+        solver->stats.reduction_seconds = scheduler_now() - load_start;
+        solver->stats.kernel_from_cache = true;
+        solver->stats.is_reduction_complete = true; // only complete kernels are stored
+        debug_log("loaded kernel with k->n == %" PRIu32 " from the cache\n", k->n);
+    }
+    else {
+        FILE* input_stream = fmemopen(input.data, input.size, "r");
+        if(!input_stream) {
+            perror("opening the input buffer failed");
+            free(input.data);
+            *fallback = _error_result(DS_STATUS_OUT_OF_MEMORY);
+            return NULL;
+        }
+        k = _reduce_input(solver, input_stream, sch, stop, streaming_ds_by_id, fallback);
+        fclose(input_stream);
+        // a kernel of an incomplete reduction depends on the time budget, so a later run with more time would
+        // get a larger kernel from the cache than it can compute itself
+        if(k != NULL && solver->stats.is_reduction_complete && !stop_requested(stop)) {
+            kernel_cache_store(options->cache_directory, &input, k);
+        }
+    }
+    free(input.data);
+    return k;
+}
+
+
+
+// write k to path, see kernel_export_pace. returns false with an error message if that failed
+static bool _export_kernel(const Kernel* k, const char* path)
+{
+    FILE* export_file = fopen(path, "w");
+    bool success = export_file != NULL && kernel_export_pace(k, export_file);
+    success = (export_file == NULL || fclose(export_file) == 0) && success;
+    if(!success) {
+        perror("exporting the kernel failed");
+    }
+    return success;
+}
+
+
+
+// read the initial solution from path, see graph_parse_solution. returns NULL with an error message if the
+// file cannot be opened or is not valid
+static bool* _read_initial_solution(const char* path, uint32_t id_max)
+{
+    FILE* initial_file = fopen(path, "r");
+    if(!initial_file) {
+        perror("opening the initial solution file failed");
+        return NULL;
+    }
+    bool* initial_ds_by_id = graph_parse_solution(id_max, initial_file);
+    fclose(initial_file);
+    return initial_ds_by_id;
+}
+
+
+
+// the measurements of the last call of ds_solve, see solve_stats.h. Valid until the next call or ds_solver_free.
+const SolveStats* ds_solver_stats(const DSSolver* solver)
+{
+    return &solver->stats;
+}
+
+
+
+// the convergence trace of the last call of ds_solve (see trace.h), or NULL if options->record_trace was false.
+// Valid until the next call or ds_solver_free.
+const Trace* ds_solver_trace(const DSSolver* solver)
+{
+    return solver->stats.trace;
+}
+
+
+
+// solve the graph that is read from file (PACE format).
+// time_limit is the wall clock time in seconds from now after which the best solution is returned, or 0
+// for no limit. The phases are scheduled for this budget, or for SCHEDULER_DEFAULT_BUDGET without a limit.
+// The solve also stops as soon as *stop_flag is set, e.g. by a signal handler. stop_flag may be NULL, but
+// then a time limit is required, because otherwise the search would never stop.
+DSResult ds_solve(DSSolver* solver, FILE* file, const DSOptions* options, double time_limit,
+                  const atomic_bool* stop_flag)
+{
+    assert(solver != NULL && file != NULL && options != NULL && time_limit >= 0.0);
+    assert(stop_flag != NULL || time_limit > 0.0);
+    SolveStats* stats = &solver->stats;
+    if(solver->interrupted_graph != NULL) {
+        graph_free(solver->interrupted_graph);
+        solver->interrupted_graph = NULL;
+    }
+    solve_stats_init(stats);
+    trace_free(&solver->trace);
+    trace_init(&solver->trace, stats->start);
+    stats->trace = options->record_trace ? &solver->trace : NULL;
+    Scheduler sch;
+    scheduler_init(&sch, time_limit > 0.0 ? time_limit : SCHEDULER_DEFAULT_BUDGET);
+    const StopCondition stop = {.flag = stop_flag != NULL ? stop_flag : &solver->never_set,
+                                .deadline = time_limit > 0.0 ? sch.start + time_limit : DBL_MAX};
+
+    bool* streaming_ds_by_id;
+    DSResult result = {.ids = NULL, .size = 0, .status = DS_STATUS_OK};
+    Kernel* k = _load_kernel(solver, file, options, &sch, &stop, &streaming_ds_by_id, &result);
+    if(!k) {
+        stats->ds_size = result.size;
+        return result;
+    }
+    stats->kernel_n = k->n;
+    stats->kernel_m = k->m;
+    stats->fixed_count = k->fixed_count;
+
+    // the warm start of the search: the given solution, or else the streaming ds
+    bool* initial_ds_by_id = streaming_ds_by_id;
+    DSStatus status = DS_STATUS_OK;
+    if(options->export_kernel_path != NULL && !_export_kernel(k, options->export_kernel_path)) {
+        status = DS_STATUS_EXPORT_FAILED;
+    }
+    if(status == DS_STATUS_OK && options->initial_solution_path != NULL) {
+        free(streaming_ds_by_id);
+        initial_ds_by_id = _read_initial_solution(options->initial_solution_path, k->id_max);
+        status = initial_ds_by_id != NULL ? DS_STATUS_OK : DS_STATUS_INVALID_INITIAL_SOLUTION;
+    }
+    if(status == DS_STATUS_OK && !_reserve_solution(solver, k->n)) {
+        status = DS_STATUS_OUT_OF_MEMORY;
+    }
+    if(status != DS_STATUS_OK) {
+        free(initial_ds_by_id);
+        kernel_free(k);
+        return _error_result(status);
+    }
+
+    if(k->n == 0) {
+        free(initial_ds_by_id);
+        result = _kernel_result(solver, k, NULL, 0);
+        stats->ds_size = result.size;
+        kernel_free(k);
+        return result;
+    }
+
+    // the search is warm started from the kernel vertices of the initial ds, see ig_initial_construct
+    bool* in_ds = solver->in_ds;
+    bool* initial_ds = NULL;
+    memset(in_ds, 0, k->n * sizeof(bool));
+    if(initial_ds_by_id != NULL) {
+        initial_ds = solver->initial_ds;
+        kernel_project_set(k, initial_ds_by_id, initial_ds);
+        free(initial_ds_by_id);
+    }
+
+    const double search_start = scheduler_now();
+    size_t ds_size;
+    if(options->engine == DS_ENGINE_CC) {
+        stats->engine = "cc";
+        ds_size = greedy_initial_solution(k, initial_ds, &stop, in_ds);
+        solve_stats_record_progress(stats, ds_size + k->fixed_count, 0, "initial");
+        ds_size = cc_solver(k, &stop, options->seed, in_ds, ds_size, stats);
+    }
+    else {
+        IGConfig ig_config = options->ig_config;
+        ig_config.seed = options->seed;
+        ig_config.initial_ds = initial_ds;
+        ig_config.stats = stats;
+        ds_size = iterated_greedy_solver(k, &ig_config, &stop, in_ds);
+    }
+    stats->search_seconds = scheduler_now() - search_start;
+    result = _kernel_result(solver, k, in_ds, ds_size);
+    stats->ds_size = result.size;
+    kernel_free(k);
+    return result;
+}
@@ -0,0 +1,108 @@
+#ifndef _DS_SOLVER_H
+#define _DS_SOLVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdatomic.h>
+
+#include "greedy.h"
+#include "solve_stats.h"
+
+
+
+// Library interface of the solver: parse a graph in the PACE format, reduce it, and search for a small
+// dominating set until the time limit is over or a stop is requested. The solver has no global state, so
+// any number of solvers can be used concurrently, for example one per thread of a batch driver.
+// An invalid input graph or initial solution, a failed kernel export or a failed allocation of the solve
+// itself is reported by DSResult.status, after a message was printed, so that the caller can go on with the
+// next graph. Only allocation failures deep inside the reduction and the search still exit the process.
+
+
+
+#define DS_DEFAULT_LOCAL_SEARCH_INTERVAL 64
+
+
+
+typedef enum DSEngine {
+    DS_ENGINE_IG, // iterated greedy, see greedy.h
+    DS_ENGINE_CC, // configuration checking local search, see cc_solver.h
+} DSEngine;
+
+
+typedef struct DSOptions {
+    DSEngine engine;
+    IGConfig ig_config; // only used by DS_ENGINE_IG. Its seed, initial_ds and stats are set by ds_solve.
+    uint64_t seed;      // the same seed and options give the same result if the time limit is not reached
+    const char* initial_solution_path; // warm start from this solution file (PACE format), NULL if none
+    const char* cache_directory;       // kernel cache directory (see kernel_cache.h), NULL if none
+    const char* export_kernel_path;    // write the kernel to this file (see kernel_export_pace), NULL if none
+    bool record_trace; // record the convergence trace of the solve, see ds_solver_trace
+    bool compact; // parse the input directly into a kernel without the reduction, for graphs that are too large
+                  // for graph_parse, see kernel_parse. The kernel cache is not used then.
+} DSOptions;
+
+
+typedef enum DSStatus {
+    DS_STATUS_OK,
+    DS_STATUS_INVALID_INPUT,            // the input is not a graph in the PACE format
+    DS_STATUS_INVALID_INITIAL_SOLUTION, // the initial solution file cannot be opened or is not valid
+    DS_STATUS_EXPORT_FAILED,            // the kernel could not be written to options->export_kernel_path
+    DS_STATUS_OUT_OF_MEMORY,
+} DSStatus;
+
+
+typedef struct DSResult {
+    const uint32_t* ids; // the vertex ids of the dominating set. Owned by the solver, valid until the next
+                         // call of ds_solve or ds_solver_free.
+    size_t size;         // the number of vertices in the dominating set
+    DSStatus status;     // if it is not DS_STATUS_OK, there is no dominating set and size is 0
+} DSResult;
+
+
+typedef struct DSSolver DSSolver;
+
+
+
+// the default options: iterated greedy with one thread, seed 0, no files
+DSOptions ds_default_options(void);
+
+
+
+// ds_solver_create may return NULL if not successful. The returned value has to be freed using
+// ds_solver_free(...). A solver can solve any number of graphs one after another. It keeps the result buffer
+// and the solution arrays of the search, which only grow, while the graph, the kernel and the search state
+// are allocated for each solve. Only the graph of an interrupted solve is kept until the next solve or
+// ds_solver_free, so that the result is available without waiting for it to be freed.
+DSSolver* ds_solver_create(void);
+
+
+
+void ds_solver_free(DSSolver* solver);
+
+
+
+// the measurements of the last call of ds_solve, see solve_stats.h. Valid until the next call or ds_solver_free.
+const SolveStats* ds_solver_stats(const DSSolver* solver);
+
+
+
+// the convergence trace of the last call of ds_solve (see trace.h), or NULL if options->record_trace was false.
+// Valid until the next call or ds_solver_free.
+const Trace* ds_solver_trace(const DSSolver* solver);
+
+
+
+// solve the graph that is read from file (PACE format).
+// time_limit is the wall clock time in seconds from now after which the best solution is returned, or 0
+// for no limit. The phases are scheduled for this budget, or for SCHEDULER_DEFAULT_BUDGET without a limit.
+// The solve also stops as soon as *stop_flag is set, e.g. by a signal handler. stop_flag may be NULL, but
+// then a time limit is required, because otherwise the search would never stop.
+// If the solve fails, result.status tells why and an error message has been printed, see DSStatus.
+DSResult ds_solve(DSSolver* solver, FILE* file, const DSOptions* options, double time_limit,
+                  const atomic_bool* stop_flag);
+
+
+
+#endif
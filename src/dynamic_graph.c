@@ -0,0 +1,406 @@
+#include "dynamic_graph.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "kernel.h"
+#include "debug_log.h"
+
+
+
+#define NOT_LOCAL UINT32_MAX // local_index of the vertices that are not in the repair kernel
+
+
+
+// make sure that the arrays indexed by vertex id have space for the id id_max, exits on failure
+static void _reserve_ids(DynamicGraph* dg, uint32_t id_max)
+{
+    if(id_max < dg->id_capacity) {
+        return;
+    }
+    const uint32_t old_capacity = dg->id_capacity;
+    const uint32_t capacity = id_max + 1 + id_max / 4; // grow by a constant factor to amortize the copying
+    dg->vertices = realloc(dg->vertices, (size_t)capacity * sizeof(DynamicVertex));
+    dg->is_in_ds = realloc(dg->is_in_ds, (size_t)capacity * sizeof(bool));
+    dg->touched = realloc(dg->touched, (size_t)capacity * sizeof(uint32_t));
+    dg->is_touched = realloc(dg->is_touched, (size_t)capacity * sizeof(bool));
+    dg->local_index = realloc(dg->local_index, (size_t)capacity * sizeof(uint32_t));
+    dg->bfs_queue = realloc(dg->bfs_queue, (size_t)capacity * sizeof(uint32_t));
+    if(!dg->vertices || !dg->is_in_ds || !dg->touched || !dg->is_touched || !dg->local_index || !dg->bfs_queue) {
+        perror("dynamic_graph: allocating arrays failed");
+        exit(EXIT_FAILURE);
+    }
+    for(uint32_t id = old_capacity; id < capacity; id++) {
+        dg->vertices[id] = (DynamicVertex) {.neighbors = NULL, .degree = 0, .capacity = 0, .is_removed = true};
+        dg->is_in_ds[id] = false;
+        dg->is_touched[id] = false;
+        dg->local_index[id] = NOT_LOCAL;
+    }
+    dg->id_capacity = capacity;
+}
+
+
+
+// (the analyzer loses track of the neighbor arrays stored in the vertex array and reports false leaks)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wanalyzer-malloc-leak"
+// build a dynamic graph from g, which must be complete and unreduced. g is not changed.
+// The dominating set is initially empty, see dynamic_graph_set_solution. Exits on failure.
+// caller is responsible for freeing using dynamic_graph_free(...)
+DynamicGraph* dynamic_graph_from_graph(const Graph* g)
+{
+    assert(g != NULL && !g->is_incomplete && g->fixed.size == 0 && g->n == g->id_max);
+    DynamicGraph* dg = calloc(1, sizeof(DynamicGraph));
+    if(!dg) {
+        perror("dynamic_graph_from_graph: allocating graph failed");
+        exit(EXIT_FAILURE);
+    }
+    _reserve_ids(dg, g->id_max);
+    dg->id_max = g->id_max;
+    dg->n = g->n;
+    dg->m = g->m;
+    for(uint32_t i = 0; i < g->n; i++) {
+        const Vertex* v = g->vertices[i];
+        DynamicVertex* dv = &(dg->vertices[v->id]);
+        dv->is_removed = false;
+        dv->degree = v->degree;
+        dv->capacity = v->degree;
+        if(v->degree > 0) {
+            dv->neighbors = malloc((size_t)v->degree * sizeof(uint32_t));
+            if(!dv->neighbors) {
+                perror("dynamic_graph_from_graph: allocating neighbors failed");
+                exit(EXIT_FAILURE);
+            }
+        }
+        for(uint32_t i_v = 0; i_v < v->degree; i_v++) {
+            dv->neighbors[i_v] = v->neighbors[i_v]->id;
+        }
+    }
+    return dg;
+}
+#pragma GCC diagnostic pop
+
+
+
+void dynamic_graph_free(DynamicGraph* dg)
+{
+    for(uint32_t id = 0; id < dg->id_capacity; id++) {
+        free(dg->vertices[id].neighbors);
+    }
+    free(dg->vertices);
+    free(dg->is_in_ds);
+    free(dg->touched);
+    free(dg->is_touched);
+    free(dg->local_index);
+    free(dg->bfs_queue);
+    free(dg);
+}
+
+
+
+// replace the dominating set of dg by the given vertices, which must form a dominating set of the graph
+void dynamic_graph_set_solution(DynamicGraph* dg, const uint32_t* ids, size_t size)
+{
+    memset(dg->is_in_ds, 0, (size_t)dg->id_capacity * sizeof(bool));
+    dg->ds_size = 0;
+    for(size_t i = 0; i < size; i++) {
+        assert(ids[i] >= 1 && ids[i] <= dg->id_max && !dg->vertices[ids[i]].is_removed);
+        if(!dg->is_in_ds[ids[i]]) {
+            dg->is_in_ds[ids[i]] = true;
+            dg->ds_size++;
+        }
+    }
+}
+
+
+
+static inline bool _exists(const DynamicGraph* dg, uint32_t v)
+{
+    return v >= 1 && v <= dg->id_max && !dg->vertices[v].is_removed;
+}
+
+
+
+// remember that the closed neighborhood of v has changed
+static inline void _touch(DynamicGraph* dg, uint32_t v)
+{
+    if(!dg->is_touched[v]) {
+        dg->is_touched[v] = true;
+        dg->touched[dg->touched_count++] = v;
+    }
+}
+
+
+
+// returns the index of v in the neighbors of u, or u->degree if v is not a neighbor
+static uint32_t _neighbor_index(const DynamicVertex* u, uint32_t v)
+{
+    uint32_t i = 0;
+    while(i < u->degree && u->neighbors[i] != v) {
+        i++;
+    }
+    return i;
+}
+
+
+
+// (false leak reports, as in dynamic_graph_from_graph)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wanalyzer-malloc-leak"
+static void _append_neighbor(DynamicVertex* u, uint32_t v)
+{
+    if(u->degree == u->capacity) {
+        u->capacity = 2 * u->capacity + 4;
+        u->neighbors = realloc(u->neighbors, (size_t)u->capacity * sizeof(uint32_t));
+        if(!u->neighbors) {
+            perror("dynamic_graph: allocating neighbors failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    u->neighbors[u->degree++] = v;
+}
+#pragma GCC diagnostic pop
+
+
+
+// add the edge {u, v}
+bool dynamic_graph_add_edge(DynamicGraph* dg, uint32_t u, uint32_t v)
+{
+    if(u == v || !_exists(dg, u) || !_exists(dg, v) || _neighbor_index(&(dg->vertices[u]), v) < dg->vertices[u].degree) {
+        return false;
+    }
+    _append_neighbor(&(dg->vertices[u]), v);
+    _append_neighbor(&(dg->vertices[v]), u);
+    dg->m++;
+    _touch(dg, u);
+    _touch(dg, v);
+    return true;
+}
+
+
+
+// remove the edge {u, v}
+bool dynamic_graph_remove_edge(DynamicGraph* dg, uint32_t u, uint32_t v)
+{
+    if(u == v || !_exists(dg, u) || !_exists(dg, v)) {
+        return false;
+    }
+    DynamicVertex* du = &(dg->vertices[u]);
+    DynamicVertex* dv = &(dg->vertices[v]);
+    const uint32_t i_u = _neighbor_index(du, v);
+    if(i_u == du->degree) {
+        return false;
+    }
+    const uint32_t i_v = _neighbor_index(dv, u);
+    assert(i_v < dv->degree);
+    du->neighbors[i_u] = du->neighbors[--du->degree];
+    dv->neighbors[i_v] = dv->neighbors[--dv->degree];
+    dg->m--;
+    _touch(dg, u);
+    _touch(dg, v);
+    return true;
+}
+
+
+
+// add an isolated vertex, whose id must be id_max + 1
+bool dynamic_graph_add_vertex(DynamicGraph* dg, uint32_t v)
+{
+    if(v != dg->id_max + 1 || v == UINT32_MAX) {
+        return false;
+    }
+    _reserve_ids(dg, v);
+    dg->id_max = v;
+    dg->vertices[v].is_removed = false;
+    dg->n++;
+    _touch(dg, v);
+    return true;
+}
+
+
+
+// remove v and its edges. Its id is not reused.
+bool dynamic_graph_remove_vertex(DynamicGraph* dg, uint32_t v)
+{
+    if(!_exists(dg, v)) {
+        return false;
+    }
+    DynamicVertex* dv = &(dg->vertices[v]);
+    while(dv->degree > 0) {
+        dynamic_graph_remove_edge(dg, v, dv->neighbors[dv->degree - 1]);
+    }
+    free(dv->neighbors);
+    *dv = (DynamicVertex) {.neighbors = NULL, .degree = 0, .capacity = 0, .is_removed = true};
+    if(dg->is_in_ds[v]) {
+        dg->is_in_ds[v] = false;
+        dg->ds_size--;
+    }
+    dg->n--;
+    return true;
+}
+
+
+
+#ifndef NDEBUG
+// for assertions only, takes O(n + m)
+static bool _is_dominating_set(const DynamicGraph* dg)
+{
+    size_t ds_size = 0;
+    for(uint32_t v = 1; v <= dg->id_max; v++) {
+        if(!_exists(dg, v)) {
+            continue;
+        }
+        if(dg->is_in_ds[v]) {
+            ds_size++;
+        }
+        bool is_dominated = dg->is_in_ds[v];
+        for(uint32_t i = 0; !is_dominated && i < dg->vertices[v].degree; i++) {
+            is_dominated = dg->is_in_ds[dg->vertices[v].neighbors[i]];
+        }
+        if(!is_dominated) {
+            return false;
+        }
+    }
+    return ds_size == dg->ds_size;
+}
+#endif
+
+
+
+// add v to the repair kernel
+static inline void _make_local(DynamicGraph* dg, uint32_t v, uint32_t* local_n)
+{
+    dg->local_index[v] = *local_n;
+    dg->bfs_queue[(*local_n)++] = v;
+}
+
+
+
+// collect the vertices of the repair kernel in bfs_queue: first the candidates, then their neighbors that
+// are neither candidates nor in the ds. Sets local_index for all of them.
+// returns the number of vertices of the repair kernel
+static uint32_t _collect_repair_vertices(DynamicGraph* dg)
+{
+    uint32_t local_n = 0;
+    for(uint32_t i = 0; i < dg->touched_count; i++) {
+        if(_exists(dg, dg->touched[i])) {
+            _make_local(dg, dg->touched[i], &local_n);
+        }
+    }
+    uint32_t head = 0;
+    for(uint32_t distance = 0; distance < DYNAMIC_REPAIR_RADIUS; distance++) {
+        const uint32_t layer_end = local_n;
+        for(; head < layer_end; head++) {
+            const DynamicVertex* u = &(dg->vertices[dg->bfs_queue[head]]);
+            for(uint32_t i = 0; i < u->degree && local_n < DYNAMIC_MAX_REPAIR_CANDIDATES; i++) {
+                if(dg->local_index[u->neighbors[i]] == NOT_LOCAL) {
+                    _make_local(dg, u->neighbors[i], &local_n);
+                }
+            }
+        }
+    }
+    const uint32_t candidate_count = local_n;
+    for(uint32_t i = 0; i < candidate_count; i++) {
+        const DynamicVertex* u = &(dg->vertices[dg->bfs_queue[i]]);
+        for(uint32_t i_u = 0; i_u < u->degree; i_u++) {
+            const uint32_t w = u->neighbors[i_u];
+            if(dg->local_index[w] == NOT_LOCAL && !dg->is_in_ds[w]) {
+                _make_local(dg, w, &local_n);
+            }
+        }
+    }
+    return local_n;
+}
+
+
+
+// build the repair kernel of the vertices in bfs_queue. The ds vertices outside of it are the fixed ones.
+// Its vertices that are in the ds are marked in initial.
+static Kernel* _repair_kernel(const DynamicGraph* dg, uint32_t local_n, bool* initial)
+{
+    size_t adjacency_size = 0;
+    uint32_t max_degree = 0;
+    for(uint32_t i = 0; i < local_n; i++) {
+        const DynamicVertex* u = &(dg->vertices[dg->bfs_queue[i]]);
+        for(uint32_t i_u = 0; i_u < u->degree; i_u++) {
+            adjacency_size += dg->local_index[u->neighbors[i_u]] != NOT_LOCAL;
+        }
+        max_degree = u->degree > max_degree ? u->degree : max_degree;
+    }
+    assert(adjacency_size % 2 == 0);
+    Kernel* k = kernel_new(local_n, adjacency_size / 2, 0);
+    uint32_t* neighbors = malloc(((size_t)max_degree + 1) * sizeof(uint32_t)); // the local neighbors of one vertex
+    if(!k || !neighbors) {
+        perror("dynamic_graph_repair: allocating kernel failed");
+        exit(EXIT_FAILURE);
+    }
+    k->id_max = dg->id_max;
+    for(uint32_t i = 0; i < local_n; i++) {
+        const uint32_t id = dg->bfs_queue[i];
+        const DynamicVertex* u = &(dg->vertices[id]);
+        k->ids[i] = id;
+        k->dominated_by_fixed[i] = 0;
+        initial[i] = dg->is_in_ds[id];
+        uint32_t degree = 0;
+        for(uint32_t i_u = 0; i_u < u->degree; i_u++) {
+            const uint32_t w = u->neighbors[i_u];
+            if(dg->local_index[w] != NOT_LOCAL) {
+                neighbors[degree++] = dg->local_index[w];
+            }
+            else if(dg->is_in_ds[w]) {
+                k->dominated_by_fixed[i]++;
+            }
+        }
+        if(!kernel_add_neighbors(k, i, neighbors, degree)) {
+            perror("dynamic_graph_repair: allocating kernel failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    free(neighbors);
+    return k;
+}
+
+
+
+// repair the dominating set after the updates since the last repair, and improve it around them with
+// iterated greedy until a stop is requested, see DynamicGraph. The result is always a dominating set of the
+// current graph, even if a stop was requested before the call.
+// returns the size of the dominating set
+size_t dynamic_graph_repair(DynamicGraph* dg, const IGConfig* config, const StopCondition* stop)
+{
+    const uint32_t local_n = _collect_repair_vertices(dg);
+    if(local_n > 0) {
+        bool* initial = malloc((size_t)local_n * sizeof(bool));
+        bool* in_ds = malloc((size_t)local_n * sizeof(bool));
+        if(!initial || !in_ds) {
+            perror("dynamic_graph_repair: allocating solution arrays failed");
+            exit(EXIT_FAILURE);
+        }
+        Kernel* k = _repair_kernel(dg, local_n, initial);
+        debug_log("repair kernel of %" PRIu32 " touched vertices: k->n == %" PRIu32 ", k->m == %" PRIu64 "\n",
+                  dg->touched_count, k->n, k->m);
+
+        IGConfig local_config = *config;
+        local_config.initial_ds = initial;
+        iterated_greedy_solver(k, &local_config, stop, in_ds);
+        for(uint32_t i = 0; i < local_n; i++) {
+            const uint32_t id = dg->bfs_queue[i];
+            if(dg->is_in_ds[id] != in_ds[i]) {
+                dg->ds_size = in_ds[i] ? dg->ds_size + 1 : dg->ds_size - 1;
+                dg->is_in_ds[id] = in_ds[i];
+            }
+            dg->local_index[id] = NOT_LOCAL;
+        }
+        kernel_free(k);
+        free(initial);
+        free(in_ds);
+    }
+    for(uint32_t i = 0; i < dg->touched_count; i++) {
+        dg->is_touched[dg->touched[i]] = false;
+    }
+    dg->touched_count = 0;
+    assert(_is_dominating_set(dg));
+    return dg->ds_size;
+}
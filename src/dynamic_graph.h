@@ -0,0 +1,104 @@
+#ifndef _DYNAMIC_GRAPH_H
+#define _DYNAMIC_GRAPH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "graph.h"
+#include "greedy.h"
+#include "scheduler.h"
+
+
+
+// A graph that stays in memory together with a dominating set of it, and that changes by batches of edge and
+// vertex insertions and deletions. The graph is kept unreduced, because the vertices that the reduction
+// fixes or removes are only optimal for the graph at the time of the reduction.
+// After a batch, the dominating set is repaired locally: the candidates are the vertices within
+// DYNAMIC_REPAIR_RADIUS of a vertex touched by the batch, and together with their neighbors outside the ds
+// they form a small kernel, in which every ds vertex outside of it counts as fixed. Iterated greedy then
+// completes the current ds on this kernel (adding dominators for undominated vertices and removing the
+// redundant ones) and improves it until the repair deadline. The rest of the ds is never changed.
+
+
+
+#define DYNAMIC_REPAIR_RADIUS         2       // the candidates of a repair are the vertices within this distance of a touched vertex
+#define DYNAMIC_MAX_REPAIR_CANDIDATES 1000000 // the BFS for the candidates stops after x vertices, except for the touched ones
+
+
+
+typedef struct DynamicVertex {
+    uint32_t* neighbors; // the ids of the neighbors
+    uint32_t degree;
+    uint32_t capacity; // the allocated length of neighbors
+    bool is_removed;
+} DynamicVertex;
+
+
+typedef struct DynamicGraph {
+    DynamicVertex* vertices; // indexed by vertex id, id_max + 1 entries. Removed vertices keep their id.
+    bool* is_in_ds;          // the current dominating set, indexed by vertex id
+    size_t ds_size;
+    size_t m;        // number of edges
+    uint32_t n;      // number of vertices that are not removed
+    uint32_t id_max; // the vertex ids are 1, ..., id_max
+    uint32_t id_capacity; // allocated entries of the arrays indexed by vertex id
+    // the vertices touched by updates since the last repair
+    uint32_t* touched;
+    uint32_t touched_count;
+    bool* is_touched;
+    // working memory of the repair, indexed by vertex id
+    uint32_t* local_index; // the index of a vertex in the repair kernel, UINT32_MAX if it is not in it
+    uint32_t* bfs_queue;   // also the list of the repair kernel vertices, by their index
+} DynamicGraph;
+
+
+
+// build a dynamic graph from g, which must be complete and unreduced. g is not changed.
+// The dominating set is initially empty, see dynamic_graph_set_solution. Exits on failure.
+// caller is responsible for freeing using dynamic_graph_free(...)
+DynamicGraph* dynamic_graph_from_graph(const Graph* g);
+
+
+
+void dynamic_graph_free(DynamicGraph* dg);
+
+
+
+// replace the dominating set of dg by the given vertices, which must form a dominating set of the graph
+void dynamic_graph_set_solution(DynamicGraph* dg, const uint32_t* ids, size_t size);
+
+
+
+// The updates return false and leave dg unchanged if they are not valid: if a vertex does not exist (or
+// is removed), if an edge to add already exists or an edge to remove does not, or for a loop.
+
+// add the edge {u, v}
+bool dynamic_graph_add_edge(DynamicGraph* dg, uint32_t u, uint32_t v);
+
+
+
+// remove the edge {u, v}
+bool dynamic_graph_remove_edge(DynamicGraph* dg, uint32_t u, uint32_t v);
+
+
+
+// add an isolated vertex, whose id must be id_max + 1
+bool dynamic_graph_add_vertex(DynamicGraph* dg, uint32_t v);
+
+
+
+// remove v and its edges. Its id is not reused.
+bool dynamic_graph_remove_vertex(DynamicGraph* dg, uint32_t v);
+
+
+
+// repair the dominating set after the updates since the last repair, and improve it around them with
+// iterated greedy until a stop is requested, see DynamicGraph. The result is always a dominating set of the
+// current graph, even if a stop was requested before the call.
+// returns the size of the dominating set
+size_t dynamic_graph_repair(DynamicGraph* dg, const IGConfig* config, const StopCondition* stop);
+
+
+
+#endif
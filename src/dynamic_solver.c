@@ -0,0 +1,242 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#include <float.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include "ds_solver.h"
+#include "dynamic_graph.h"
+#include "graph.h"
+#include "cli.h"
+#include "sigterm.h"
+#include "scheduler.h"
+#include "solution_writer.h"
+
+
+
+// Solves a graph once, then keeps it in memory and reads batches of updates from stdin. After each batch,
+// the dominating set is repaired around the changes (see dynamic_graph.h) and printed to stdout.
+// Update format, one per line:
+//   a u v   add the edge {u, v}
+//   d u v   delete the edge {u, v}
+//   a v     add the vertex v, which must be the largest id so far + 1
+//   d v     delete the vertex v and its edges
+//   s       end of the batch: repair and print the solution
+//   c ...   comment
+// A batch that is not ended by s is solved at the end of the input. Invalid updates are skipped with a warning.
+// On SIGTERM, the current solve stops, and the solution of the graph with all updates applied so far is
+// printed before the program exits.
+
+
+
+#define DYNAMIC_DEFAULT_REPAIR_SECONDS 1.0
+
+
+
+static void _print_usage(FILE* stream, const char* program_name)
+{
+    fprintf(stream,
+            "Usage: %s [--repair-time S] [solver options] graph.gr < updates > solutions\n"
+            "  --repair-time S     the time limit of the repair after each batch of updates (default: %.1f seconds)\n"
+            "  The solver options are used for the initial solution, and --time-limit (default: %d seconds) only\n"
+            "  limits the initial solve. The iterated greedy options also apply to the repairs. They are:\n",
+            program_name, DYNAMIC_DEFAULT_REPAIR_SECONDS, (int)SCHEDULER_DEFAULT_BUDGET);
+    cli_print_solver_options(stream);
+    fprintf(stream, "  --help              print this help text\n");
+}
+
+
+
+static DSOptions _parse_options(int argc, char** argv, double* time_limit, double* repair_time, const char** graph_path)
+{
+    DSOptions options = ds_default_options();
+    options.seed = (uint64_t)time(NULL);
+    *time_limit = SCHEDULER_DEFAULT_BUDGET;
+    *repair_time = DYNAMIC_DEFAULT_REPAIR_SECONDS;
+    *graph_path = NULL;
+    for(int i = 1; i < argc; i++) {
+        if(cli_parse_solver_option(argc, argv, &i, &options, time_limit)) {
+            continue;
+        }
+        if(strcmp(argv[i], "--repair-time") == 0 && i + 1 < argc) {
+            *repair_time = cli_parse_seconds(argv[i], argv[i + 1]);
+            i++;
+        }
+        else if(strcmp(argv[i], "--help") == 0) {
+            _print_usage(stdout, argv[0]);
+            exit(EXIT_SUCCESS);
+        }
+        else if(strncmp(argv[i], "--", 2) != 0 && *graph_path == NULL) {
+            *graph_path = argv[i];
+        }
+        else {
+            fprintf(stderr, "unknown or incomplete option '%s'\n", argv[i]);
+            _print_usage(stderr, argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if(*graph_path == NULL) {
+        fprintf(stderr, "no graph file\n");
+        _print_usage(stderr, argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    return options;
+}
+
+
+
+static FILE* _open_graph(const char* graph_path)
+{
+    FILE* file = fopen(graph_path, "r");
+    if(!file) {
+        perror(graph_path);
+        exit(EXIT_FAILURE);
+    }
+    return file;
+}
+
+
+
+static void _print_solution(const DynamicGraph* dg)
+{
+    fflush(stdout);
+    SolutionWriter writer;
+    solution_writer_init(&writer, STDOUT_FILENO);
+    solution_writer_add(&writer, dg->ds_size);
+    for(uint32_t id = 1; id <= dg->id_max; id++) {
+        if(dg->is_in_ds[id]) {
+            solution_writer_add(&writer, id);
+        }
+    }
+    if(!solution_writer_finish(&writer)) {
+        perror("writing the solution failed");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+
+// true if line[offset...] contains only whitespace
+static bool _is_blank_from(const char* line, int offset)
+{
+    return line[offset + (int)strspn(&(line[offset]), " \t\r\n")] == '\0';
+}
+
+
+
+// apply the update in line to dg, returns false if the line is not a valid update. Only lines with exactly
+// the tokens of an update are accepted, so that a typo in an edge update cannot delete a vertex.
+static bool _apply_update(DynamicGraph* dg, const char* line)
+{
+    char operation;
+    uint32_t u, v;
+    int end_of_u = -1, end_of_v = -1;
+    const int count = sscanf(line, " %c %" SCNu32 "%n %" SCNu32 "%n", &operation, &u, &end_of_u, &v, &end_of_v);
+    if((count == 3 && !_is_blank_from(line, end_of_v)) || (count == 2 && !_is_blank_from(line, end_of_u))) {
+        return false;
+    }
+    if(count == 3 && operation == 'a') {
+        return dynamic_graph_add_edge(dg, u, v);
+    }
+    if(count == 3 && operation == 'd') {
+        return dynamic_graph_remove_edge(dg, u, v);
+    }
+    if(count == 2 && operation == 'a') {
+        return dynamic_graph_add_vertex(dg, u);
+    }
+    if(count == 2 && operation == 'd') {
+        return dynamic_graph_remove_vertex(dg, u);
+    }
+    return false;
+}
+
+
+
+// repair the solution after a batch of updates for at most repair_time seconds, and print it
+static void _repair_and_print(DynamicGraph* dg, const IGConfig* ig_config, double repair_time)
+{
+    const StopCondition stop = {.flag = sigterm_flag(), .deadline = scheduler_now() + repair_time};
+    dynamic_graph_repair(dg, ig_config, &stop);
+    _print_solution(dg);
+}
+
+
+
+int main(int argc, char** argv)
+{
+    double time_limit, repair_time;
+    const char* graph_path;
+    const DSOptions options = _parse_options(argc, argv, &time_limit, &repair_time, &graph_path);
+    sigterm_register_interrupting_handler(); // a SIGTERM also ends the wait for the next update
+
+    // the initial solution uses the whole pipeline including the reduction, and its result is valid for the
+    // unreduced graph, which is then parsed again to be kept in memory
+    DSSolver* solver = ds_solver_create();
+    if(!solver) {
+        perror("ds_solver_create failed");
+        exit(EXIT_FAILURE);
+    }
+    FILE* file = _open_graph(graph_path);
+    const DSResult result = ds_solve(solver, file, &options, time_limit, sigterm_flag());
+    fclose(file);
+    if(result.status != DS_STATUS_OK) { // the message has been printed
+        exit(EXIT_FAILURE);
+    }
+    const StopCondition parse_stop = {.flag = sigterm_flag(), .deadline = DBL_MAX};
+    file = _open_graph(graph_path);
+    Graph* g = graph_parse(file, &parse_stop);
+    fclose(file);
+    if(!g) {
+        exit(EXIT_FAILURE);
+    }
+    if(g->is_incomplete) { // SIGTERM
+        if(!solution_write(STDOUT_FILENO, result.ids, result.size)) {
+            perror("writing the solution failed");
+            exit(EXIT_FAILURE);
+        }
+        graph_free(g);
+        ds_solver_free(solver);
+        return EXIT_SUCCESS;
+    }
+    DynamicGraph* dg = dynamic_graph_from_graph(g);
+    graph_free(g);
+    dynamic_graph_set_solution(dg, result.ids, result.size);
+    ds_solver_free(solver);
+    _print_solution(dg);
+
+    IGConfig ig_config = options.ig_config;
+    ig_config.seed = options.seed;
+    char* line = NULL;
+    size_t line_capacity = 0;
+    size_t line_number = 0;
+    bool batch_pending = false;
+    while(!atomic_load(sigterm_flag())) {
+        const bool end_of_input = getline(&line, &line_capacity, stdin) == -1; // or interrupted by SIGTERM
+        line_number++;
+        if(end_of_input || line[0] == 's') {
+            if(batch_pending) {
+                _repair_and_print(dg, &ig_config, repair_time);
+                batch_pending = false;
+            }
+            if(end_of_input) {
+                break;
+            }
+        }
+        else if(line[0] != 'c' && line[0] != '\n') {
+            if(_apply_update(dg, line)) {
+                batch_pending = true;
+            }
+            else {
+                fprintf(stderr, "ignoring invalid update in line %zu: %s", line_number, line);
+            }
+        }
+    }
+    if(batch_pending) { // SIGTERM during a batch. The repair returns at once, but with a dominating set.
+        _repair_and_print(dg, &ig_config, repair_time);
+    }
+    free(line);
+    dynamic_graph_free(dg);
+    return EXIT_SUCCESS;
+}
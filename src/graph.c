@@ -3,12 +3,14 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <errno.h>
 
 
 
-typedef struct Edge {
-    Vertex* a;
-    Vertex* b;
+
+typedef struct Edge { // the vertex ids of the endpoints, so that the streaming ds needs no pointer chasing
+    uint32_t a;
+    uint32_t b;
 } Edge;
 
 
@@ -27,6 +29,7 @@ void graph_free(Graph* g)
     }
     free(g->vertices);
     g->vertices = NULL;
+    free(g->in_streaming_ds);
     for(size_t fixed_idx = 0; fixed_idx < g->fixed.size; fixed_idx++) {
         Vertex* v = g->fixed.vertices[fixed_idx];
         assert(v->neighbors == NULL);
@@ -49,96 +52,271 @@ static void _graph_add_edge(Vertex* u, Vertex* v)
 
 
 
+#define PARSE_STOP_CHECK_INTERVAL 65536 // check for a stop request after every x edges
+#define FIXUP_STOP_CHECK_INTERVAL 4096 // and after every x vertices of the streaming ds fixup
+
+
+
+// the streaming ds is a dominating set of all edges read so far, but a vertex may be dominated by a ds
+// vertex through an edge that was read before the neighbor joined the ds. Mark these vertices as dominated
+// as well, then dominate the remaining ones by their neighbor of highest degree, or by themselves if the
+// adjacency lists have not been built or a stop is requested in the meantime.
+static void _streaming_ds_fixup(Graph* g, Vertex** vertex_by_id, const Edge* edges, uint64_t edges_read,
+                                bool* is_dominated, const StopCondition* stop)
+{
+    bool* in_ds = g->in_streaming_ds;
+    bool by_neighbors = !g->is_incomplete;
+    for(uint64_t i = 0; i < edges_read; i++) {
+        const uint32_t a = edges[i].a, b = edges[i].b;
+        is_dominated[a] |= in_ds[b];
+        is_dominated[b] |= in_ds[a];
+    }
+    for(uint32_t id = 1; id <= g->id_max; id++) {
+        if(by_neighbors && id % FIXUP_STOP_CHECK_INTERVAL == 0 && stop_requested(stop)) {
+            by_neighbors = false;
+        }
+        if(is_dominated[id]) {
+            continue;
+        }
+        Vertex* best = vertex_by_id[id];
+        for(uint32_t i = 0; by_neighbors && i < vertex_by_id[id]->degree; i++) {
+            if(vertex_by_id[id]->neighbors[i]->degree > best->degree) {
+                best = vertex_by_id[id]->neighbors[i];
+            }
+        }
+        assert(!in_ds[best->id]);
+        in_ds[best->id] = true;
+        g->streaming_ds_size++;
+        is_dominated[best->id] = true;
+        for(uint32_t i = 0; by_neighbors && i < best->degree; i++) {
+            is_dominated[best->neighbors[i]->id] = true;
+        }
+    }
+}
+
+
+
+// free everything graph_parse has allocated so far when it cannot continue, and set errno to error
+// returns NULL
+static Graph* _abort_parse(Graph* g, Vertex** vertex_by_id, Edge* edges, uint32_t* degrees, bool* is_dominated,
+                           int error)
+{
+    for(uint32_t id = 1; vertex_by_id != NULL && id <= g->id_max; id++) {
+        if(vertex_by_id[id] != NULL) {
+            free(vertex_by_id[id]->neighbors);
+            free(vertex_by_id[id]);
+        }
+    }
+    free(vertex_by_id);
+    free(g->vertices);
+    free(g->in_streaming_ds);
+    da_free_internals(&(g->fixed));
+    free(g);
+    free(edges);
+    free(degrees);
+    free(is_dominated);
+    errno = error;
+    return NULL;
+}
+
+
+
+// skip the comment lines at the start of file and read the problem line "p ds n m" of the PACE format.
+// Returns false with an error message and errno == EINVAL if it is not valid or n or m is too large.
+bool graph_parse_problem_line(FILE* file, uint32_t* n, uint64_t* m)
+{
+    int c = fgetc(file);
+    while(c == 'c') { // while the first char of a line is 'c', skip that entire line
+        while((c = fgetc(file)) != EOF && c != '\n') { // empty loop
+        }
+        c = fgetc(file); // get first char of next line
+    }
+    uintmax_t tmp_n, tmp_m;
+    // the first non-comment line must be "p ds n m"
+    if(c != 'p' || fscanf(file, " ds %" SCNuMAX " %" SCNuMAX, &tmp_n, &tmp_m) != 2) {
+        fprintf(stderr, "graph_parse: the input does not start with a valid line \"p ds n m\"\n");
+        errno = EINVAL;
+        return false;
+    }
+    // the vertex ids are 32 bit, and n + 1 must still fit. The edge count is only limited by the memory.
+    if((tmp_n >= (uintmax_t)UINT32_MAX) || (tmp_m > (uintmax_t)(SIZE_MAX / sizeof(Edge)))) {
+        fprintf(stderr, "graph_parse: the number of vertices or edges is too large\n");
+        errno = EINVAL;
+        return false;
+    }
+    *n = (uint32_t)tmp_n;
+    *m = (uint64_t)tmp_m;
+    return true;
+}
+
+
+
 // caller is responsible for freeing using graph_free(...)
-Graph* graph_parse(FILE* file)
+// If a stop is requested while the edges are parsed or their adjacency lists are built, parsing stops and the
+// returned graph is incomplete.
+// Also builds the streaming ds of the graph in one pass over the edges, see Graph.
+// Returns NULL with an error message if the input is not valid (then errno == EINVAL) or an allocation
+// failed (then errno == ENOMEM).
+Graph* graph_parse(FILE* file, const StopCondition* stop)
 {
+    uint32_t n;
+    uint64_t m;
+    if(!graph_parse_problem_line(file, &n, &m)) {
+        return NULL;
+    }
+
     Graph* g = calloc(1, sizeof(Graph));
     if(!g) {
+        perror("graph_parse: allocating graph failed");
         return NULL;
     }
     if(!da_init(&(g->fixed), 128)) { // initial_capacity = 128 is arbitrary but seems reasonable
+        perror("graph_parse: allocating graph failed");
+        free(g);
+        errno = ENOMEM;
         return NULL;
     }
-
-    char c = (char)fgetc(file);
-    while(c == 'c') { // while the first char of a line is 'c', skip that entire line
-        for(c = (char)fgetc(file); c != '\n'; c = (char)fgetc(file)) { // empty loop
-            assert(c != EOF);
-        }
-        c = (char)fgetc(file); // get first char of next line
-    }
-    assert(c == 'p'); // first char of the first non-comment line should be a p
-    c = (char)fgetc(file);
-    assert(c == ' ');
-    c = (char)fgetc(file);
-    assert(c == 'd');
-    c = (char)fgetc(file);
-    assert(c == 's');
-    c = (char)fgetc(file);
-    assert(c == ' ');
-
-    uintmax_t tmp_n, tmp_m;
-    uint32_t n, m;
-    fscanf(file, "%" SCNuMAX "%" SCNuMAX "\n", &tmp_n, &tmp_m); // n and m
-    if((tmp_n > (uintmax_t)UINT32_MAX) || (tmp_m > (uintmax_t)UINT32_MAX)) {
-        fprintf(stderr, "graph_parse_stdin: uint32_t is not large enough to hold number of vertices/edges.");
-        exit(EXIT_FAILURE);
-    }
-    n = (uint32_t)tmp_n;
-    m = (uint32_t)tmp_m;
     g->n = n;
     g->m = m;
+    g->id_max = n;
 
     // make a temporary array in order to efficiently access the vertices by their id
-    Vertex** tmp_vertex_arr_by_id = calloc(n + 1, sizeof(Vertex*));
+    Vertex** tmp_vertex_arr_by_id = calloc((size_t)n + 1, sizeof(Vertex*));
     g->vertices = malloc(n * sizeof(Vertex*));
-    Edge* edges = calloc(m, sizeof(Edge));               // temporary array for the edges
-    uint32_t* degrees = calloc(n + 1, sizeof(uint32_t)); // temporary array to keep track of the degrees
-    if(tmp_vertex_arr_by_id == NULL || g->vertices == NULL || edges == NULL || degrees == NULL) {
-        perror("graph_parse_stdin: allocating array failed");
-        exit(EXIT_FAILURE);
+    Edge* edges = calloc(m, sizeof(Edge));                       // temporary array for the edges
+    uint32_t* degrees = calloc((size_t)n + 1, sizeof(uint32_t)); // temporary array to keep track of the degrees
+    bool* is_dominated = calloc((size_t)n + 1, sizeof(bool));    // temporary array for the streaming ds
+    g->in_streaming_ds = calloc((size_t)n + 1, sizeof(bool));
+    if(tmp_vertex_arr_by_id == NULL || g->vertices == NULL || edges == NULL || degrees == NULL || is_dominated == NULL ||
+       g->in_streaming_ds == NULL) {
+        perror("graph_parse: allocating array failed");
+        return _abort_parse(g, tmp_vertex_arr_by_id, edges, degrees, is_dominated, ENOMEM);
     }
 
     for(uint32_t id = 1; id < n + 1; id++) {
         if(!(tmp_vertex_arr_by_id[id] = calloc(1, sizeof(Vertex)))) {
-            perror("graph_parse_stdin: allocating memory for a single Vertex failed");
-            exit(EXIT_FAILURE);
+            perror("graph_parse: allocating memory for a single Vertex failed");
+            return _abort_parse(g, tmp_vertex_arr_by_id, edges, degrees, is_dominated, ENOMEM);
         }
         tmp_vertex_arr_by_id[id]->id = id; // initialize all non-zero data of the vertex
     }
 
-    // continue parsing
-    for(uint32_t i = 0; i < m; i++) {
+    // continue parsing, and build the streaming ds on the way: if neither endpoint of an edge is dominated
+    // yet, the endpoint with the higher degree so far joins the ds
+    uint64_t edges_read = 0;
+    for(uint64_t i = 0; i < m; i++) {
+        if(i % PARSE_STOP_CHECK_INTERVAL == 0 && stop_requested(stop)) {
+            g->is_incomplete = true;
+            g->m = 0;
+            break;
+        }
         uint32_t u_id, v_id;
-        if(fscanf(file, "\t%" SCNu32 " %" SCNu32 "\n", &u_id, &v_id) != 2) {
-            assert(false);
+        if(fscanf(file, "\t%" SCNu32 " %" SCNu32 "\n", &u_id, &v_id) != 2 || u_id == 0 || u_id > n || v_id == 0 ||
+           v_id > n || u_id == v_id) {
+            fprintf(stderr, "graph_parse: edge %" PRIu64 " of %" PRIu64 " is missing or not valid\n", i + 1, m);
+            return _abort_parse(g, tmp_vertex_arr_by_id, edges, degrees, is_dominated, EINVAL);
         }
-        edges[i].a = tmp_vertex_arr_by_id[u_id];
-        edges[i].b = tmp_vertex_arr_by_id[v_id];
+        edges[i].a = u_id;
+        edges[i].b = v_id;
         degrees[u_id]++;
         degrees[v_id]++;
+        if(!is_dominated[u_id] && !is_dominated[v_id]) {
+            g->in_streaming_ds[degrees[u_id] >= degrees[v_id] ? u_id : v_id] = true;
+            g->streaming_ds_size++;
+            is_dominated[u_id] = is_dominated[v_id] = true;
+        }
+        else {
+            is_dominated[u_id] |= g->in_streaming_ds[v_id];
+            is_dominated[v_id] |= g->in_streaming_ds[u_id];
+        }
+        edges_read++;
     }
-    for(uint32_t id = 1; id <= n; id++) {
+    for(uint32_t id = 1; id <= n && !g->is_incomplete; id++) {
         if(degrees[id] > 0) {
             if(!(tmp_vertex_arr_by_id[id]->neighbors = malloc((size_t)degrees[id] * sizeof(Vertex*)))) {
-                perror("graph_parse_stdin: allocating neighbors array of a vertex failed");
-                exit(EXIT_FAILURE);
+                perror("graph_parse: allocating neighbors array of a vertex failed");
+                return _abort_parse(g, tmp_vertex_arr_by_id, edges, degrees, is_dominated, ENOMEM);
             }
         }
     }
-    for(uint32_t i = 0; i < m; i++) {
-        _graph_add_edge(edges[i].a, edges[i].b);
+    // building the adjacency lists and completing the streaming ds with them takes a while on large graphs, so
+    // it is interrupted like the parsing
+    for(uint64_t i = 0; i <= g->m; i++) {
+        if((i % PARSE_STOP_CHECK_INTERVAL == 0 || i == g->m) && stop_requested(stop)) {
+            g->is_incomplete = true;
+            g->m = 0;
+            break;
+        }
+        if(i < g->m) {
+            _graph_add_edge(tmp_vertex_arr_by_id[edges[i].a], tmp_vertex_arr_by_id[edges[i].b]);
+        }
     }
+    _streaming_ds_fixup(g, tmp_vertex_arr_by_id, edges, edges_read, is_dominated, stop);
 
     memcpy(g->vertices, &(tmp_vertex_arr_by_id[1]), (size_t)n * sizeof(Vertex*));
     free(tmp_vertex_arr_by_id);
     free(edges);
     free(degrees);
+    free(is_dominated);
     return g;
 }
 
 
 
+// skip comment lines and read the next unsigned integer, returns false at the end of the file
+static bool _next_solution_number(FILE* file, uintmax_t* number)
+{
+    int c;
+    while((c = fgetc(file)) != EOF) {
+        if(c == 'c') { // skip the entire line
+            while((c = fgetc(file)) != EOF && c != '\n') { // empty loop
+            }
+        }
+        else if(c >= '0' && c <= '9') {
+            ungetc(c, file);
+            return fscanf(file, "%" SCNuMAX, number) == 1;
+        }
+        else if(c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            return false;
+        }
+    }
+    return false;
+}
+
+
+
+// reads a dominating set in the PACE output format (the number of vertices, then one vertex id per line,
+// lines starting with 'c' are comments) of a graph with the vertex ids 1, ..., id_max and returns it as an
+// array indexed by vertex id with id_max + 1 entries. The set does not need to be dominating.
+// Returns NULL with an error message if the file is not valid or an allocation failed.
+// caller is responsible for freeing the returned array
+bool* graph_parse_solution(uint32_t id_max, FILE* file)
+{
+    bool* in_ds_by_id = calloc((size_t)id_max + 1, sizeof(bool));
+    if(!in_ds_by_id) {
+        perror("graph_parse_solution: allocating array failed");
+        return NULL;
+    }
+    uintmax_t size, id;
+    if(!_next_solution_number(file, &size)) {
+        fprintf(stderr, "graph_parse_solution: the solution file does not start with the number of vertices\n");
+        free(in_ds_by_id);
+        return NULL;
+    }
+    for(uintmax_t i = 0; i < size; i++) {
+        if(!_next_solution_number(file, &id) || id == 0 || id > id_max) {
+            fprintf(stderr, "graph_parse_solution: vertex %ju of the solution file is missing or not a vertex of the graph\n",
+                    i + 1);
+            free(in_ds_by_id);
+            return NULL;
+        }
+        in_ds_by_id[id] = true;
+    }
+    return in_ds_by_id;
+}
+
+
+
 // debug function
 // graph_name is optional and can be NULL
 // dominated vertices will green, fixed verticed will be cyan, and removed vertices will be red
@@ -7,29 +7,20 @@
 #include <stdio.h>
 
 #include "dynamic_array.h"
+#include "scheduler.h"
 
 
 
 // fields are ordered by their expected size, to minimize padding as much as possible
 typedef struct Vertex {
     struct Vertex** neighbors; // array of pointers to the neighbors
-    double vote;
     uint32_t id;     // the name of the vertex. Must be unique and must not be 0.
     uint32_t degree; // this is the length of the array neighbors
-    uint32_t dominated_by_number; // the number of neighbors in the ds this vertex is dominated by. For use by the greedy solver.
-    uint32_t queued; // used by local deconstruction to check if a vertex has been queued in the current BFS run yet
-    union {
-        uint32_t neighbor_tag; /*   For the reduction algorithm to be used as a temporary marker.
-                                    This value must never be the id of an existing but non-neighboring vertex.
-                                    0 is a valid value, because vertex ids must not be 0. */
-        uint32_t pq_kv_idx;    /*   May only be accessed by the internals of the priority queue.
-                                    The index this vertex has inside the priority queue. */
-    };
-    union {
-        bool is_removed; // for use during the reduction phase
-        bool is_in_pq; // May be read by anyone but must not be changed by anything but the priority queue internals
-    };
-    bool is_in_ds; // saves if this vertex has been chosen for the domination set in the current solution
+    uint32_t dominated_by_number; // the number of fixed vertices this vertex is dominated by.
+    uint32_t neighbor_tag; /*   For the reduction algorithm to be used as a temporary marker.
+                                This value must never be the id of an existing but non-neighboring vertex.
+                                0 is a valid value, because vertex ids must not be 0. */
+    bool is_removed; // for use during the reduction phase
 } Vertex;
 
 
@@ -37,8 +28,16 @@ typedef struct Graph {
     Vertex** vertices;  // array of vertices in the graph
     DynamicArray fixed; // list of vertices that are known to be optimal choices for any dominating set.
     uint32_t n;         // number of vertices remaining
-    uint32_t m;         // number of edges remaining
+    uint64_t m;         // number of edges remaining
+    uint32_t removed_count; // number of vertices the reduction has marked removed so far, including the fixed ones
     // fixed vertices that were removed from the graph do not count towards n and m
+    bool is_incomplete; // if parsing was interrupted by a stop request. Then g contains all vertices, but not
+                        // all edges, and only the streaming ds may be used.
+    // a cheap dominating set of the input graph that is built while the edges are parsed, indexed by vertex
+    // id. It is valid even if the graph is incomplete, and it is not changed by the reduction.
+    bool* in_streaming_ds;
+    uint32_t streaming_ds_size;
+    uint32_t id_max; // the vertex ids are 1, ..., id_max
 } Graph;
 
 
@@ -49,8 +48,28 @@ void graph_free(Graph* g);
 
 
 
+// skip the comment lines at the start of file and read the problem line "p ds n m" of the PACE format.
+// Returns false with an error message and errno == EINVAL if it is not valid or n or m is too large.
+bool graph_parse_problem_line(FILE* file, uint32_t* n, uint64_t* m);
+
+
+
 // caller is responsible for freeing using graph_free(...)
-Graph* graph_parse(FILE* file);
+// If a stop is requested while the edges are parsed or their adjacency lists are built, parsing stops and the
+// returned graph is incomplete.
+// Also builds the streaming ds of the graph in one pass over the edges, see Graph.
+// Returns NULL with an error message if the input is not valid (then errno == EINVAL) or an allocation
+// failed (then errno == ENOMEM).
+Graph* graph_parse(FILE* file, const StopCondition* stop);
+
+
+
+// reads a dominating set in the PACE output format (the number of vertices, then one vertex id per line,
+// lines starting with 'c' are comments) of a graph with the vertex ids 1, ..., id_max and returns it as an
+// array indexed by vertex id with id_max + 1 entries. The set does not need to be dominating.
+// Returns NULL with an error message if the file is not valid or an allocation failed.
+// caller is responsible for freeing the returned array
+bool* graph_parse_solution(uint32_t id_max, FILE* file);
 
 
 
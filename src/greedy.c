@@ -2,371 +2,689 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <assert.h>
-#include <signal.h>
-#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
-#include "assert_allow_float_equal.h"
+#include "ig_state.h"
+#include "scheduler.h"
+#include "local_search.h"
 #include "fast_random.h"
+#include "perf_counters.h"
 #include "debug_log.h"
 
 
 
-static bool _g_sigterm_received = false;
+#define IG_SYNC_INTERVAL 128 // every x iterations, a worker checks if another worker has found a better solution
+#define IG_LOCAL_SEARCH_MIN_STEPS 1000 // a local search phase makes at least x steps, or n / 4 if that is more
+#define IG_LOCAL_SEARCH_MIN_INTERVAL 4    // the adaptive interval between local search phases stays within these bounds
+#define IG_LOCAL_SEARCH_MAX_INTERVAL 4096
+#define IG_RATE_DECAY 0.9 // after every local search phase, older improvement rate measurements count this much less
 
+#define IG_CONSENSUS_POOL_SIZE           8    // the number of elite solutions that the consensus is taken over
+#define IG_CONSENSUS_SAMPLE_INTERVAL     64   // the saved solution joins the pool every x iterations (a sample takes O(n), like an iteration)
+#define IG_CONSENSUS_MAX_CONTESTED       0.5  // the vertices are only fixed if at most this share of them is contested
+#define IG_CONSENSUS_STALL_ITERATIONS    1024 // the fixing is undone after x iterations without improvement
 
+#define IG_PARTITION_ROUND_SECONDS    0.5 // how long the threads work on their parts before the kernel is partitioned anew
+#define IG_BOUNDARY_PASS_SECONDS      0.05 // how long the whole kernel is searched after each round (at least one iteration)
+#define IG_PARTITION_NOT_ASSIGNED     UINT32_MAX
 
-// return the new ds size
-static size_t _make_minimal(Graph* g, size_t current_ds_size)
+
+
+// factors by which the deconstruction strength of worker i % (number of factors) differs from the default
+// parameters. Worker 0 always uses the default parameters.
+static const double _g_worker_strength_factors[] = {1.0, 0.5, 2.0, 0.75, 1.5, 0.25, 3.0, 1.25};
+
+
+
+// The best solution found by any worker so far. Workers publish their improvements here and copy the
+// solution from here if they have fallen behind.
+typedef struct SolutionBoard {
+    atomic_size_t ds_size; // may be read without holding lock. SIZE_MAX as long as nothing was published.
+    pthread_mutex_t lock;  // must be held while accessing the arrays
+    bool* is_in_ds;
+    uint32_t* dominated_by_number;
+    SolveStats* stats; // records every published improvement, NULL if there are no stats
+} SolutionBoard;
+
+
+
+// The elite pool of a portfolio worker for the consensus fixing, see IGConfig. The pool consists of the
+// saved solutions at IG_CONSENSUS_POOL_SIZE sample points, and only the number of pooled solutions that
+// contain each vertex is stored. The vertices that are in all or in none of them are fixed by restricting
+// the state to the contested vertices (the others) and their neighbors, until the search stalls.
+typedef struct ConsensusPool {
+    uint8_t* in_count;      // the number of pooled solutions that contain each vertex
+    bool* is_contested;     // the candidates of the state while the fixing is active
+    uint32_t* region;       // the contested vertices and their neighbors
+    uint32_t size;          // the number of pooled solutions
+    bool is_fixed;          // whether the state is currently restricted to the contested region
+    size_t fixed_ds_size;   // while fixed: the number of ds vertices outside of the region
+    size_t iterations_without_improvement; // while fixed
+} ConsensusPool;
+
+
+
+typedef struct IGWorker {
+    IGState state;
+    SolutionBoard* board; // only used by the portfolio mode
+    ConsensusPool* consensus; // only used by the portfolio mode, NULL if the consensus fixing is disabled
+    LocalSearch* ls;      // only used by the portfolio mode, NULL if local search is disabled
+    const bool* initial_ds; // only used by the portfolio mode, see IGConfig
+    size_t local_search_interval; // the initial one, it adapts during the search
+    double deadline;      // only used by the partition mode, the end of the current round
+    size_t ig_iterations;
+    size_t local_search_phases;   // only used by the portfolio mode
+    double local_search_seconds;
+    pthread_t thread;
+    unsigned index;
+} IGWorker;
+
+
+
+// A partition of the kernel vertices into parts. Each part is the region of one worker.
+typedef struct Partition {
+    uint32_t* part_of;      // the part of each vertex
+    uint32_t* vertices;     // all vertices, grouped by part
+    uint32_t* part_offsets; // part p consists of vertices[part_offsets[p]], ..., vertices[part_offsets[p + 1] - 1]
+    uint32_t* bfs_queue;    // working memory for the BFS growth
+    bool* is_interior;      // whether all neighbors of a vertex are in the same part as the vertex itself
+    uint32_t num_parts;
+} Partition;
+
+
+
+static void _init_workers(IGWorker* workers, unsigned num_workers, const Kernel* k, const double* votes,
+                          const IGState* shared, uint64_t base_seed, const StopCondition* stop)
 {
-    assert(g != NULL);
-    for(size_t i_vertices = 0; i_vertices < g->n; i_vertices++) {
-        Vertex* v = g->vertices[i_vertices];
-        if(v->is_in_ds && v->dominated_by_number > 1) {
-            bool v_redundant = true;
-            for(uint32_t i_v = 0; i_v < v->degree; i_v++) {
-                if(v->neighbors[i_v]->dominated_by_number < 2) {
-                    assert(v->neighbors[i_v]->dominated_by_number >= 1); // otherwise ds would not be a dominating set
-                    v_redundant = false;
-                    break;
-                }
-            }
-            if(v_redundant) {
-                v->is_in_ds = false;
-                current_ds_size--;
-                v->dominated_by_number--;
-                for(uint32_t i_v = 0; i_v < v->degree; i_v++) {
-                    v->neighbors[i_v]->dominated_by_number--;
-                }
-            }
-        }
+    const size_t count_strength_factors = sizeof(_g_worker_strength_factors) / sizeof(_g_worker_strength_factors[0]);
+    for(unsigned i = 0; i < num_workers; i++) {
+        workers[i].index = i;
+        workers[i].ig_iterations = 0;
+        ig_state_init(&(workers[i].state), k, votes, shared, base_seed + i * 0x9e3779b97f4a7c15ULL,
+                      _g_worker_strength_factors[i % count_strength_factors], stop);
     }
-    return current_ds_size;
 }
 
 
 
-// must only be called if v is currently in the ds.
-static inline void _remove_from_ds(Vertex* v)
+// run worker_function for all workers. Worker 0 runs on this thread, all others get their own.
+static void _run_workers(IGWorker* workers, unsigned num_workers, void* (*worker_function)(void*))
 {
-    assert(v->is_in_ds);
-    v->dominated_by_number--;
-    for(uint32_t i_v = 0; i_v < v->degree; i_v++) {
-        v->neighbors[i_v]->dominated_by_number--;
+    for(unsigned i = 1; i < num_workers; i++) {
+        if(pthread_create(&(workers[i].thread), NULL, worker_function, &(workers[i])) != 0) {
+            perror("iterated_greedy_solver: creating worker thread failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    worker_function(&(workers[0]));
+    for(unsigned i = 1; i < num_workers; i++) {
+        pthread_join(workers[i].thread, NULL);
     }
-    v->is_in_ds = false;
 }
 
 
 
-// returns the resulting ds size
-static size_t _random_deconstruction(Graph* g, double removal_probability, size_t current_ds_size, fast_random_t* rng)
+// publish the saved solution of s, which has ds_size vertices in the whole kernel (see _worker_ds_size),
+// if it is better than the best one on the board. iteration and source describe how it was found (see TraceEvent).
+static void _board_publish(SolutionBoard* board, const IGState* s, size_t ds_size, uint64_t iteration,
+                           const char* source)
 {
-    const uint64_t rand_threshold = (uint64_t)(removal_probability * (double)FAST_RANDOM_MAX);
-    for(size_t i_vertices = 0; i_vertices < g->n; i_vertices++) {
-        Vertex* v = g->vertices[i_vertices];
-        if(v->is_in_ds && fast_random(rng) < rand_threshold) {
-            _remove_from_ds(v);
-            current_ds_size--;
+    if(ds_size >= atomic_load(&board->ds_size)) {
+        return;
+    }
+    pthread_mutex_lock(&board->lock);
+    if(ds_size < atomic_load(&board->ds_size)) { // check again, another worker may have been faster
+        memcpy(board->dominated_by_number, s->saved_dominated_by_number, (size_t)s->k->n * sizeof(uint32_t));
+        memcpy(board->is_in_ds, s->saved_is_in_ds, (size_t)s->k->n * sizeof(bool));
+        atomic_store(&board->ds_size, ds_size);
+        if(board->stats != NULL) {
+            solve_stats_record_progress(board->stats, ds_size + s->k->fixed_count, iteration, source);
         }
     }
-    return current_ds_size;
+    pthread_mutex_unlock(&board->lock);
 }
 
 
 
-typedef struct QueueElem {
-    struct QueueElem* next;
-    Vertex* val;
-} QueueElem;
+// replace the saved and the current solution of s by the one on the board if that one is better
+static void _board_sync(SolutionBoard* board, IGState* s)
+{
+    if(atomic_load_explicit(&board->ds_size, memory_order_relaxed) >= s->saved_ds_size) {
+        return;
+    }
+    pthread_mutex_lock(&board->lock);
+    memcpy(s->saved_dominated_by_number, board->dominated_by_number, (size_t)s->k->n * sizeof(uint32_t));
+    memcpy(s->saved_is_in_ds, board->is_in_ds, (size_t)s->k->n * sizeof(bool));
+    s->saved_ds_size = atomic_load(&board->ds_size);
+    pthread_mutex_unlock(&board->lock);
+    ig_restore_solution(s);
+}
+
 
-typedef struct Queue {
-    QueueElem* head;
-    QueueElem* tail;
-} Queue;
 
-static inline bool _queue_is_empty(Queue* q)
+// (the analyzer does not see that the arrays are freed together with the pool and reports false leaks)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wanalyzer-malloc-leak"
+static ConsensusPool* _consensus_new(const Kernel* k)
 {
-    return q->head == NULL;
+    ConsensusPool* pool = calloc(1, sizeof(ConsensusPool));
+    if(!pool) {
+        return NULL;
+    }
+    pool->in_count = calloc((size_t)k->n + 1, sizeof(uint8_t));
+    pool->is_contested = malloc(((size_t)k->n + 1) * sizeof(bool));
+    pool->region = malloc(((size_t)k->n + 1) * sizeof(uint32_t));
+    if(!pool->in_count || !pool->is_contested || !pool->region) {
+        free(pool->in_count);
+        free(pool->is_contested);
+        free(pool->region);
+        free(pool);
+        return NULL;
+    }
+    return pool;
 }
+#pragma GCC diagnostic pop
+
 
-static inline void _enqueue(Queue* q, Vertex* new_val)
+
+static void _consensus_free(ConsensusPool* pool)
 {
-    QueueElem* new_q_elem = calloc(1, sizeof(QueueElem));
-    if(!new_q_elem) {
-        perror("enqueue: calloc failed");
-        exit(EXIT_FAILURE);
+    if(pool != NULL) {
+        free(pool->in_count);
+        free(pool->is_contested);
+        free(pool->region);
+        free(pool);
     }
-    new_q_elem->val = new_val;
-    if(!_queue_is_empty(q)) {
-        assert(q->tail != NULL);
-        q->tail->next = new_q_elem;
-        q->tail = new_q_elem;
-    }
-    else {
-        q->head = new_q_elem;
-        q->tail = new_q_elem;
+}
+
+
+
+// the size of the saved solution of the worker in the whole kernel, even while its state is restricted
+static inline size_t _worker_ds_size(const IGWorker* w)
+{
+    const ConsensusPool* pool = w->consensus;
+    return pool != NULL && pool->is_fixed ? pool->fixed_ds_size + w->state.saved_ds_size : w->state.saved_ds_size;
+}
+
+
+
+// add the saved solution of s to the pool
+static void _consensus_sample(ConsensusPool* pool, const IGState* s)
+{
+    for(uint32_t v = 0; v < s->k->n; v++) {
+        if(s->saved_is_in_ds[v]) {
+            pool->in_count[v]++;
+        }
     }
+    pool->size++;
 }
 
-static inline Vertex* _dequeue(Queue* q)
+
+
+// restrict s to the contested vertices of the full pool and their neighbors, unless (almost) all vertices
+// are contested or none are. Empties the pool. The solution of s must be saved.
+static void _consensus_fix(ConsensusPool* pool, IGState* s)
 {
-    assert(!_queue_is_empty(q));
-    Vertex* result = q->head->val;
-    QueueElem* to_free = q->head;
-    q->head = q->head->next;
-    free(to_free);
-    return result;
+    const Kernel* k = s->k;
+    assert(pool->size == IG_CONSENSUS_POOL_SIZE && !pool->is_fixed);
+    uint32_t contested_count = 0;
+    for(uint32_t v = 0; v < k->n; v++) {
+        pool->is_contested[v] = pool->in_count[v] != 0 && pool->in_count[v] != IG_CONSENSUS_POOL_SIZE;
+        if(pool->is_contested[v]) {
+            contested_count++;
+        }
+        pool->in_count[v] = 0;
+    }
+    pool->size = 0;
+    if(contested_count == 0 || (double)contested_count > IG_CONSENSUS_MAX_CONTESTED * (double)k->n) {
+        return;
+    }
+    uint32_t region_size = 0;
+    for(uint32_t v = 0; v < k->n; v++) {
+        bool in_region = pool->is_contested[v];
+        uint32_t u;
+        for(KernelNeighbors it = kernel_neighbors(k, v); !in_region && kernel_next_neighbor(&it, &u);) {
+            in_region = pool->is_contested[u];
+        }
+        if(in_region) {
+            pool->region[region_size++] = v;
+        }
+    }
+    const size_t ds_size = s->saved_ds_size;
+    ig_state_set_region(s, pool->region, region_size, pool->is_contested);
+    pool->fixed_ds_size = ds_size - s->saved_ds_size;
+    pool->is_fixed = true;
+    pool->iterations_without_improvement = 0;
+    debug_log("consensus: fixed %" PRIu32 " of %" PRIu32 " vertices, the region has %" PRIu32 " vertices\n",
+              k->n - contested_count, k->n, region_size);
 }
 
-static inline void _clear_queue(Queue* q)
+
+
+// advance the consensus fixing of worker w after an iteration, see ConsensusPool
+static void _consensus_step(IGWorker* w, bool improvement, size_t iteration)
 {
-    while(!_queue_is_empty(q)) {
-        QueueElem* to_free = q->head;
-        q->head = q->head->next;
-        free(to_free);
+    ConsensusPool* pool = w->consensus;
+    IGState* s = &(w->state);
+    if(pool->is_fixed) {
+        pool->iterations_without_improvement = improvement ? 0 : pool->iterations_without_improvement + 1;
+        if(pool->iterations_without_improvement >= IG_CONSENSUS_STALL_ITERATIONS) {
+            ig_state_clear_region(s);
+            pool->is_fixed = false;
+            debug_log("consensus: released the fixed vertices with saved_ds_size == %zu\n", s->saved_ds_size);
+        }
+    }
+    else if(iteration % IG_CONSENSUS_SAMPLE_INTERVAL == 0) {
+        _consensus_sample(pool, s);
+        if(pool->size == IG_CONSENSUS_POOL_SIZE) {
+            _consensus_fix(pool, s);
+        }
     }
 }
 
 
-// create a local hole in the ds coverage using breadth-first search
-// returns the resulting ds size
-static size_t _local_deconstruction(Graph* g, const size_t max_removals, const size_t current_ds_size, fast_random_t* rng)
+
+static void* _portfolio_worker_run(void* arg)
 {
-    static uint32_t queued_current_marker = 0;
-    queued_current_marker++;
-    // the queued field of the vertices is used like a bool. However, to avoid having to reset all
-    // queued fields to false, the next local deconstruction run increments queued_current_marker and
-    // checks the queued fields against a new value.
-
-    size_t start_index = (size_t)(((__uint128_t)g->n * (__uint128_t)fast_random(rng)) / ((__uint128_t)FAST_RANDOM_MAX + 1));
-    assert(start_index < g->n);
-
-    Queue q = {0};
-    _enqueue(&q, g->vertices[start_index]);
-    size_t count_removed = 0;
-    size_t ds_vertices_queued = 0;
-    while((!_queue_is_empty(&q)) && count_removed < max_removals) {
-        Vertex* v = _dequeue(&q);
-        if(v->is_in_ds) {
-            _remove_from_ds(v);
-            count_removed++;
+    IGWorker* w = arg;
+    IGState* s = &(w->state);
+
+    s->current_ds_size = ig_initial_construct(s, w->initial_ds);
+    _board_publish(w->board, s, s->saved_ds_size, 0, "initial");
+
+    const size_t local_search_steps = s->k->n / 4 > IG_LOCAL_SEARCH_MIN_STEPS ? s->k->n / 4 : IG_LOCAL_SEARCH_MIN_STEPS;
+    // the time between the local search phases adapts to the improvement rates of both kinds of phases
+    PhaseRate ig_rate = {0}, ls_rate = {0};
+    size_t local_search_interval = w->local_search_interval;
+    size_t iterations_until_ls = local_search_interval;
+    double ig_phase_start = scheduler_now();
+    size_t ig_phase_start_size = s->saved_ds_size;
+    size_t iteration = 0;
+    for(; !stop_requested(s->stop); iteration++) {
+        const bool improvement = ig_iteration(s, iteration);
+        if(improvement) {
+            _board_publish(w->board, s, _worker_ds_size(w), iteration, ig_operator_name(s->last_operator));
+        }
+        if(w->consensus != NULL) {
+            _consensus_step(w, improvement, iteration);
         }
-        // enqueue neighbors of v if not already enqueued / visited
-        for(uint32_t i_v = 0; i_v < v->degree && ds_vertices_queued < max_removals; i_v++) {
-            Vertex* u = v->neighbors[i_v];
-            if(u->queued != queued_current_marker) {
-                u->queued = queued_current_marker;
-                _enqueue(&q, u);
-                if(u->is_in_ds) {
-                    ds_vertices_queued++;
-                }
+        // the local search and the board solutions are not restricted to the contested region, so they
+        // wait while vertices are fixed
+        const bool is_fixed = w->consensus != NULL && w->consensus->is_fixed;
+        if(w->ls != NULL && !is_fixed && --iterations_until_ls == 0) {
+            const double ls_start = scheduler_now();
+            phase_rate_add(&ig_rate, (double)ig_phase_start_size - (double)s->saved_ds_size, ls_start - ig_phase_start);
+            // after ig_iteration, the current solution is the saved one, and local search never makes it worse.
+            // The result is saved even without improvement because the plateau swaps diversify the search.
+            const size_t ls_start_size = s->saved_ds_size;
+            const bool ls_improvement = ls_run(w->ls, s, local_search_steps) < s->saved_ds_size;
+            ig_save_solution(s);
+            if(ls_improvement) {
+                _board_publish(w->board, s, s->saved_ds_size, iteration, "local_search");
             }
+            ig_phase_start = scheduler_now();
+            ig_phase_start_size = s->saved_ds_size;
+            w->local_search_phases++;
+            w->local_search_seconds += ig_phase_start - ls_start;
+            phase_rate_add(&ls_rate, (double)ls_start_size - (double)s->saved_ds_size, ig_phase_start - ls_start);
+            if(phase_rate_get(&ls_rate) > phase_rate_get(&ig_rate) && local_search_interval > IG_LOCAL_SEARCH_MIN_INTERVAL) {
+                local_search_interval /= 2; // local search is more productive, run it more often
+            }
+            else if(phase_rate_get(&ls_rate) < phase_rate_get(&ig_rate) && local_search_interval < IG_LOCAL_SEARCH_MAX_INTERVAL) {
+                local_search_interval *= 2;
+            }
+            phase_rate_decay(&ig_rate, IG_RATE_DECAY);
+            phase_rate_decay(&ls_rate, IG_RATE_DECAY);
+            iterations_until_ls = local_search_interval;
+        }
+        if(!is_fixed && iteration % IG_SYNC_INTERVAL == IG_SYNC_INTERVAL - 1) {
+            _board_sync(w->board, s);
         }
     }
-    _clear_queue(&q);
-    return current_ds_size - count_removed;
+    w->ig_iterations = iteration;
+    perf_counters_thread_finish();
+    return NULL;
 }
 
 
 
-static void _init_votes(Graph* g)
+// add the operator counters and priority queue operations of s to stats, which may be NULL
+static void _collect_stats(SolveStats* stats, const IGState* s)
 {
-    assert(g != NULL);
-    for(size_t vertices_idx = 0; vertices_idx < g->n; vertices_idx++) {
-        Vertex* v = g->vertices[vertices_idx];
-        v->vote = 1.0 / (double)(v->degree + 1);
+    if(stats == NULL) {
+        return;
+    }
+    for(int op = 0; op < IG_NUM_OPERATORS; op++) {
+        IGOperatorCounters* sum = &(stats->ig_operators[op]);
+        sum->iterations += s->counters[op].iterations;
+        sum->improvements += s->counters[op].improvements;
+        sum->equal_moves += s->counters[op].equal_moves;
+        sum->deconstruct_seconds += s->counters[op].deconstruct_seconds;
+        sum->construct_seconds += s->counters[op].construct_seconds;
     }
+    stats->pq_operations += pq_operation_count(s->pq);
 }
 
 
 
-static size_t _greedy_vote_construct(Graph* g, size_t current_ds_size)
+// (the analyzer reports the consensus pools of the other workers as leaked when exiting on an allocation failure)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wanalyzer-malloc-leak"
+// every thread searches on the whole kernel with its own copy of the solution
+// returns the size of the best ds, which is written to in_ds
+static size_t _portfolio_solver(const Kernel* k, const double* votes, const IGConfig* config,
+                                const StopCondition* stop, bool* in_ds, size_t* ig_iterations)
 {
-    uint32_t undominated_vertices = 0; // the total number of undominated vertices remaining in the graph
-
-    PQueue* pq = pq_new();
-    if(!pq) {
-        perror("greedy: pq_new failed");
+    const unsigned num_threads = config->num_threads;
+    SolutionBoard board = {.ds_size = SIZE_MAX, .stats = config->stats};
+    board.is_in_ds = malloc(((size_t)k->n + 1) * sizeof(bool));
+    board.dominated_by_number = malloc(((size_t)k->n + 1) * sizeof(uint32_t));
+    IGWorker* workers = calloc(num_threads, sizeof(IGWorker));
+    if(!board.is_in_ds || !board.dominated_by_number || !workers || pthread_mutex_init(&board.lock, NULL) != 0) {
+        perror("iterated_greedy_solver: initialization failed");
         exit(EXIT_FAILURE);
     }
-    for(uint32_t vertices_idx = 0; vertices_idx < g->n; vertices_idx++) {
-        Vertex* v = g->vertices[vertices_idx];
-        double weight = 0.0; // aka votes received
-        if(v->dominated_by_number == 0) {
-            undominated_vertices++;
-            weight = v->vote;
+    _init_workers(workers, num_threads, k, votes, NULL, config->seed, stop);
+    for(unsigned i = 0; i < num_threads; i++) {
+        workers[i].board = &board;
+        workers[i].initial_ds = config->initial_ds;
+        workers[i].local_search_interval = config->local_search_interval;
+        if(config->consensus) {
+            workers[i].consensus = _consensus_new(k);
+            if(!workers[i].consensus) {
+                perror("iterated_greedy_solver: allocating consensus pool failed");
+                exit(EXIT_FAILURE);
+            }
         }
-        for(uint32_t i = 0; i < v->degree; i++) {
-            Vertex* u = v->neighbors[i];
-            if(u->dominated_by_number == 0) {
-                weight += u->vote;
+        if(config->local_search_interval > 0) {
+            workers[i].ls = ls_new(k);
+            if(!workers[i].ls) {
+                perror("iterated_greedy_solver: allocating local search failed");
+                exit(EXIT_FAILURE);
             }
         }
-        v->is_in_pq = false;
-        if(weight > 0.0) {
-            pq_insert(pq, (KeyValPair) {.key = weight, .val = v});
+    }
+
+    _run_workers(workers, num_threads, _portfolio_worker_run);
+
+    // every worker has published its best solution, so the board holds the best one of all workers
+    const size_t ds_size = atomic_load(&board.ds_size);
+    memcpy(in_ds, board.is_in_ds, (size_t)k->n * sizeof(bool));
+    *ig_iterations = 0;
+    for(unsigned i = 0; i < num_threads; i++) {
+        *ig_iterations += workers[i].ig_iterations;
+        _collect_stats(config->stats, &(workers[i].state));
+        if(config->stats != NULL) {
+            config->stats->local_search_phases += workers[i].local_search_phases;
+            config->stats->local_search_seconds += workers[i].local_search_seconds;
         }
+        ig_state_free(&(workers[i].state));
+        ls_free(workers[i].ls);
+        _consensus_free(workers[i].consensus);
     }
+    free(workers);
+    pthread_mutex_destroy(&board.lock);
+    free(board.is_in_ds);
+    free(board.dominated_by_number);
+    return ds_size;
+}
+#pragma GCC diagnostic pop
 
 
-    while(undominated_vertices > 0) {
-        assert(!pq_is_empty(pq));
-        KeyValPair kv = pq_pop(pq);
-        Vertex* v = kv.val;
-        assert(!v->is_in_ds);
-        v->is_in_ds = true;
-        current_ds_size++;
-        double v_is_newly_dominated = 0.0;
-        v->dominated_by_number++;
-        if(v->dominated_by_number == 1) {
-            v_is_newly_dominated = 1.0;
-            undominated_vertices--;
-        }
 
-        for(uint32_t i_v = 0; i_v < v->degree; i_v++) {
-            Vertex* u1 = v->neighbors[i_v];
-            u1->dominated_by_number++;
-            double delta_weight_u1 = v_is_newly_dominated * v->vote;
-            if(u1->dominated_by_number == 1) { // if v is the first one to dominate u1
-                delta_weight_u1 += u1->vote;   // u1 no longer votes for itself
-                undominated_vertices--;
-                for(uint32_t i_u1 = 0; i_u1 < u1->degree; i_u1++) {
-                    Vertex* u2 = u1->neighbors[i_u1];
-                    // because u1 is now dominated, u2 no longer receives u1's vote
-                    if(u2->is_in_pq) {
-                        pq_decrease_priority(pq, u2, pq_get_key(pq, u2) - u1->vote);
-                    }
-                }
-            }
-            if(u1->is_in_pq && delta_weight_u1 > 0) {
-                pq_decrease_priority(pq, u1, pq_get_key(pq, u1) - delta_weight_u1);
+static uint32_t _random_index(fast_random_t* rng, uint32_t bound)
+{
+    return (uint32_t)(((__uint128_t)bound * (__uint128_t)fast_random(rng)) / ((__uint128_t)FAST_RANDOM_MAX + 1));
+}
+
+
+
+// assign all unassigned vertices reachable from the queued ones to the part of the queued vertex they
+// are reached from, by breadth-first search
+static void _partition_grow(const Kernel* k, Partition* p, size_t queue_head, size_t queue_tail, uint32_t* part_sizes)
+{
+    while(queue_head < queue_tail) {
+        uint32_t v = p->bfs_queue[queue_head++];
+        uint32_t u;
+        for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+            if(p->part_of[u] == IG_PARTITION_NOT_ASSIGNED) {
+                p->part_of[u] = p->part_of[v];
+                part_sizes[p->part_of[v]]++;
+                p->bfs_queue[queue_tail++] = u;
             }
         }
     }
-    pq_free(pq);
-    current_ds_size = _make_minimal(g, current_ds_size);
-    return current_ds_size;
 }
 
 
 
-static void _sigterm_handler(int sig)
+// partition the kernel into p->num_parts parts by growing them simultaneously from random start vertices
+// using breadth-first search. Components that are not reached are added to the smallest part.
+static void _partition_kernel(const Kernel* k, Partition* p, fast_random_t* rng)
 {
-    (void)sig; // supress warning for unused parameter
-    _g_sigterm_received = true;
+    assert(p->num_parts >= 1 && p->num_parts <= k->n);
+    uint32_t* part_sizes = &(p->part_offsets[1]); // count the sizes in place, part_offsets[0] is always 0
+    for(uint32_t part = 0; part < p->num_parts; part++) {
+        part_sizes[part] = 0;
+    }
+    for(uint32_t v = 0; v < k->n; v++) {
+        p->part_of[v] = IG_PARTITION_NOT_ASSIGNED;
+    }
+    size_t queue_tail = 0;
+    for(uint32_t part = 0; part < p->num_parts; part++) {
+        uint32_t start = _random_index(rng, k->n);
+        while(p->part_of[start] != IG_PARTITION_NOT_ASSIGNED) { // the start vertices must be distinct
+            start = (start + 1) % k->n;
+        }
+        p->part_of[start] = part;
+        part_sizes[part]++;
+        p->bfs_queue[queue_tail++] = start;
+    }
+    _partition_grow(k, p, 0, queue_tail, part_sizes);
+    for(uint32_t v = 0; v < k->n; v++) {
+        if(p->part_of[v] == IG_PARTITION_NOT_ASSIGNED) { // v is in a component that does not contain any start vertex
+            uint32_t smallest_part = 0;
+            for(uint32_t part = 1; part < p->num_parts; part++) {
+                smallest_part = part_sizes[part] < part_sizes[smallest_part] ? part : smallest_part;
+            }
+            p->part_of[v] = smallest_part;
+            part_sizes[smallest_part]++;
+            p->bfs_queue[0] = v;
+            _partition_grow(k, p, 0, 1, part_sizes);
+        }
+    }
+
+    // group the vertices by part (counting sort)
+    p->part_offsets[0] = 0;
+    for(uint32_t part = 1; part <= p->num_parts; part++) {
+        p->part_offsets[part] += p->part_offsets[part - 1];
+    }
+    // now part_offsets[part + 1] is the end of part
+    for(uint32_t v = k->n; v-- > 0;) {
+        p->vertices[--(p->part_offsets[p->part_of[v] + 1])] = v;
+    }
+    // now part_offsets[part + 1] is the start of part, so shift it to the left
+    for(uint32_t part = 0; part < p->num_parts; part++) {
+        p->part_offsets[part] = p->part_offsets[part + 1];
+    }
+    p->part_offsets[p->num_parts] = k->n;
+
+    for(uint32_t v = 0; v < k->n; v++) {
+        p->is_interior[v] = true;
+        uint32_t u;
+        for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+            if(p->part_of[u] != p->part_of[v]) {
+                p->is_interior[v] = false;
+                break;
+            }
+        }
+    }
 }
 
 
 
-static void _register_sigterm_handler(void)
+static void* _partition_worker_run(void* arg)
 {
-    struct sigaction sa = {0};
-    sa.sa_handler = _sigterm_handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = SA_RESTART; // restart interrupted syscalls
-    if(sigaction(SIGTERM, &sa, NULL) == -1) {
-        perror("sigaction failed to register SIGTERM handler");
-        exit(EXIT_FAILURE);
-    }
-    if(sigaction(SIGINT, &sa, NULL) == -1) { // also terminate on Ctrl+C
-        // don't care if registering the SIGINT handler fails, it is not necessary but only QOL
+    IGWorker* w = arg;
+    while(!stop_requested(w->state.stop) && scheduler_now() < w->deadline) {
+        ig_iteration(&(w->state), w->ig_iterations++);
     }
+    perf_counters_thread_finish();
+    return NULL;
 }
 
 
 
-static inline double _clamp(double x, double min, double max)
+// record the saved solution of the global state of the partition mode in stats if it improved.
+// iterations is the number of iterations of all threads so far.
+static void _record_partition_progress(SolveStats* stats, const IGState* global, uint64_t iterations,
+                                       const char* source, size_t* recorded_ds_size)
 {
-    return (x < min) ? min : (x > max) ? max : x;
+    if(stats != NULL && global->saved_ds_size < *recorded_ds_size) {
+        *recorded_ds_size = global->saved_ds_size;
+        solve_stats_record_progress(stats, global->saved_ds_size + global->k->fixed_count, iterations, source);
+    }
 }
 
 
 
-// runs iterated greedy algorithm on the graph until a sigterm signal is received.
-// v->is_in_ds must be set to false for all vertices before calling this function.
-// returns the number of vertices in the dominating set.
-size_t iterated_greedy_solver(Graph* g)
+// All threads improve the same solution. In each round, the kernel is partitioned, and every thread
+// may only change the interior vertices of its part, whose closed neighborhoods lie completely inside
+// the part. The threads therefore never write to the same memory. The boundary vertices are changed
+// by a short search on the whole kernel after each round, and because the kernel is partitioned anew
+// in every round, each vertex is regularly an interior vertex of some part.
+// returns the size of the best ds, which is written to in_ds
+static size_t _partition_solver(const Kernel* k, const double* votes, const IGConfig* config,
+                                const StopCondition* stop, bool* in_ds, size_t* ig_iterations)
 {
-    _register_sigterm_handler();
-    _init_votes(g);
+    const unsigned num_threads = config->num_threads;
+    const uint32_t num_parts = num_threads < k->n ? num_threads : k->n;
+    IGState global;
+    ig_state_init(&global, k, votes, NULL, config->seed ^ 0x5bd1e995ULL, 1.0, stop);
+    global.current_ds_size = ig_initial_construct(&global, config->initial_ds);
+    size_t recorded_ds_size = SIZE_MAX;
+    _record_partition_progress(config->stats, &global, 0, "initial", &recorded_ds_size);
+
+    Partition p = {.num_parts = num_parts};
+    p.part_of = malloc(((size_t)k->n + 1) * sizeof(uint32_t));
+    p.vertices = malloc(((size_t)k->n + 1) * sizeof(uint32_t));
+    p.part_offsets = malloc(((size_t)num_parts + 1) * sizeof(uint32_t));
+    p.bfs_queue = malloc(((size_t)k->n + 1) * sizeof(uint32_t));
+    p.is_interior = malloc(((size_t)k->n + 1) * sizeof(bool));
+    IGWorker* workers = calloc(num_parts, sizeof(IGWorker));
+    if(!p.part_of || !p.vertices || !p.part_offsets || !p.bfs_queue || !p.is_interior || !workers) {
+        perror("iterated_greedy_solver: allocating partition failed");
+        exit(EXIT_FAILURE);
+    }
+    _init_workers(workers, num_parts, k, votes, &global, config->seed, stop);
     fast_random_t rng;
-    fast_random_init(&rng, (uint64_t)time(NULL));
-
-    // create two array that are use to save and restore the best solution found so far:
-    bool* in_ds = calloc(g->n, sizeof(bool));
-    uint32_t* dominated_by_numbers = malloc(g->n * sizeof(uint32_t));
-    if(in_ds == NULL || dominated_by_numbers == NULL) {
-        exit(1);
-    }
-
-    size_t current_ds_size = _greedy_vote_construct(g, 0); // get initial solution
-    for(uint32_t i = 0; i < g->n; i++) {                   // save the initial solution
-        dominated_by_numbers[i] = g->vertices[i]->dominated_by_number;
-        in_ds[i] = g->vertices[i]->is_in_ds;
-    }
-    size_t saved_ds_size = current_ds_size; // the size of the ds saved in dominated_by_numbers and in_ds
-
-
-    // these metaheuristic values can be tweaked for optimal results and performance
-    const double score_decay_factor = 0.9; // must be >0 and <1
-    const double reward_improvement = 1.0;
-    const double reward_equal = 0.0;        // should be >=0 and <=reward_improvement
-    const double minimum_probability = 0.2; // the minimal probability for a deconstruction approach to be selected, regardless of how low its score is. Must be >=0 and <=0.5
-    double score_local_decon = 0.0;
-    double score_random_decon = 1.0; // Testing has shown that random deconstruction is better in the beginning, so make sure to prioritize it initially
-
-    size_t ig_iteration = 0;
-    for(; !_g_sigterm_received; ig_iteration++) {
-        double probability_local_decon = score_local_decon / (score_local_decon + score_random_decon + 1.e-10); // the tiny summand prevents division by 0
-        probability_local_decon = _clamp(probability_local_decon, minimum_probability, 1.0 - minimum_probability);
-        debug_log("score_local_decon == %.6f  score_random_decon == %.6f  probability_local_decon == %.6f\t",
-                  score_local_decon, score_random_decon, probability_local_decon);
-        // deconstruct solution
-        if(fast_random(&rng) < (uint64_t)(probability_local_decon * (double)FAST_RANDOM_MAX)) {
-            debug_log("local deconstruction \t");
-            current_ds_size = _local_deconstruction(g, 40, current_ds_size, &rng); // max removals can be tweaked
-            current_ds_size = _greedy_vote_construct(g, current_ds_size);
-            double reward = current_ds_size < saved_ds_size  ? reward_improvement :
-                            current_ds_size == saved_ds_size ? reward_equal :
-                                                               0.0;
-            score_local_decon = score_local_decon * score_decay_factor + reward;
+    fast_random_init(&rng, config->seed ^ 0x2545f4914f6cdd1dULL);
+
+    size_t global_iterations = 0;
+    for(size_t round = 0; !stop_requested(stop); round++) {
+        _partition_kernel(k, &p, &rng);
+        const double deadline = scheduler_now() + IG_PARTITION_ROUND_SECONDS;
+        for(uint32_t part = 0; part < num_parts; part++) {
+            ig_state_set_region(&(workers[part].state), &(p.vertices[p.part_offsets[part]]),
+                                p.part_offsets[part + 1] - p.part_offsets[part], p.is_interior);
+            workers[part].deadline = deadline;
         }
-        else {
-            debug_log("random deconstruction\t");
-            current_ds_size = _random_deconstruction(g, 0.006, current_ds_size, &rng); // removal probability can be tweaked
-            current_ds_size = _greedy_vote_construct(g, current_ds_size);
-            double reward = current_ds_size < saved_ds_size  ? reward_improvement :
-                            current_ds_size == saved_ds_size ? reward_equal :
-                                                               0.0;
-            score_random_decon = score_random_decon * score_decay_factor + reward;
+        size_t ds_size_in_parts_before = 0;
+        for(uint32_t part = 0; part < num_parts; part++) {
+            ds_size_in_parts_before += workers[part].state.saved_ds_size;
         }
 
-        if(current_ds_size <= saved_ds_size) {
-            debug_log("%s current_ds_size == %zu\tsaved_ds_size == %zu\t\tig_iteration == %zu\n",
-                      current_ds_size < saved_ds_size ? "IMPROVEMENT:" : "EQUAL: =    ", current_ds_size,
-                      saved_ds_size, ig_iteration);
-            for(uint32_t i = 0; i < g->n; i++) { // save the current solution
-                dominated_by_numbers[i] = g->vertices[i]->dominated_by_number;
-                in_ds[i] = g->vertices[i]->is_in_ds;
-            }
-            saved_ds_size = current_ds_size;
+        _run_workers(workers, num_parts, _partition_worker_run);
+
+        // the parts are disjoint, so the improvements of all parts add up
+        size_t ds_size_in_parts_after = 0;
+        for(uint32_t part = 0; part < num_parts; part++) {
+            ds_size_in_parts_after += workers[part].state.saved_ds_size;
         }
-        else { // restore saved solution
-            debug_log("worse:       current_ds_size == %zu\tsaved_ds_size == %zu\t\tig_iteration == %zu\n",
-                      current_ds_size, saved_ds_size, ig_iteration);
-            for(uint32_t i = 0; i < g->n; i++) {
-                g->vertices[i]->dominated_by_number = dominated_by_numbers[i];
-                g->vertices[i]->is_in_ds = in_ds[i];
-            }
-            current_ds_size = saved_ds_size;
+        global.saved_ds_size = global.saved_ds_size - ds_size_in_parts_before + ds_size_in_parts_after;
+        global.current_ds_size = global.saved_ds_size;
+        debug_log("partition round %zu finished with saved_ds_size == %zu\n", round, global.saved_ds_size);
+
+        // boundary pass
+        const double boundary_deadline = scheduler_now() + IG_BOUNDARY_PASS_SECONDS;
+        do {
+            ig_iteration(&global, global_iterations++);
+        } while(!stop_requested(stop) && scheduler_now() < boundary_deadline);
+        uint64_t iterations = global_iterations;
+        for(uint32_t part = 0; part < num_parts; part++) {
+            iterations += workers[part].ig_iterations;
         }
+        _record_partition_progress(config->stats, &global, iterations, "partition", &recorded_ds_size);
+    }
+
+    const size_t ds_size = global.saved_ds_size;
+    memcpy(in_ds, global.saved_is_in_ds, (size_t)k->n * sizeof(bool));
+    *ig_iterations = global_iterations;
+    for(uint32_t part = 0; part < num_parts; part++) {
+        *ig_iterations += workers[part].ig_iterations;
+        _collect_stats(config->stats, &(workers[part].state));
+        ig_state_free(&(workers[part].state));
+    }
+    free(workers);
+    _collect_stats(config->stats, &global);
+    ig_state_free(&global);
+    free(p.part_of);
+    free(p.vertices);
+    free(p.part_offsets);
+    free(p.bfs_queue);
+    free(p.is_interior);
+    return ds_size;
+}
+
+
+
+// computes a dominating set of k with the greedy vote construction, which is also the initial solution
+// of the iterated greedy algorithm. It is written to in_ds, which must have space for k->n elements.
+// initial is an optional set of vertices to start from, see ig_initial_construct, and may be NULL.
+// If a stop is requested, the construction is completed trivially.
+// returns the number of vertices in the dominating set.
+size_t greedy_initial_solution(const Kernel* k, const bool* initial, const StopCondition* stop, bool* in_ds)
+{
+    assert(k != NULL && in_ds != NULL);
+    double* votes = ig_new_votes(k);
+    IGState s;
+    ig_state_init(&s, k, votes, NULL, 0, 1.0, stop); // the construction does not use random numbers
+    const size_t ds_size = ig_initial_construct(&s, initial);
+    memcpy(in_ds, s.is_in_ds, (size_t)k->n * sizeof(bool));
+    ig_state_free(&s);
+    free(votes);
+    return ds_size;
+}
+
+
+
+// runs iterated greedy algorithm on the kernel until a stop is requested.
+// The best dominating set found is written to in_ds, which must have space for k->n elements.
+// returns the number of vertices in the dominating set.
+size_t iterated_greedy_solver(const Kernel* k, const IGConfig* config, const StopCondition* stop, bool* in_ds)
+{
+    assert(k != NULL && config != NULL && in_ds != NULL && config->num_threads >= 1);
+    double* votes = ig_new_votes(k);
+
+    size_t ig_iterations = 0;
+    size_t ds_size;
+    if(config->parallel_mode == IG_PARALLEL_PARTITION && config->num_threads > 1) {
+        ds_size = _partition_solver(k, votes, config, stop, in_ds, &ig_iterations);
+    }
+    else {
+        ds_size = _portfolio_solver(k, votes, config, stop, in_ds, &ig_iterations);
+    }
+    if(config->stats != NULL) {
+        config->stats->search_iterations = ig_iterations;
     }
-    fprintf(stderr, "final ds size == %zu\t\tds + fixed == %zu\t\tgreedy iterations == %zu\n",
-            current_ds_size, current_ds_size + g->fixed.size, ig_iteration);
+    fprintf(stderr, "final ds size == %zu\t\tds + fixed == %zu\t\tgreedy iterations == %zu\t\tthreads == %u\n",
+            ds_size, ds_size + k->fixed_count, ig_iterations, config->num_threads);
     fflush(stderr);
 
-    free(in_ds);
-    free(dominated_by_numbers);
-    return current_ds_size;
+    free(votes);
+    return ds_size;
 }
@@ -1,15 +1,47 @@
 #ifndef _GREEDY_H
 #define _GREEDY_H
 
-#include "graph.h"
-#include "pqueue.h"
+#include <stdbool.h>
+#include <stddef.h>
 
+#include "kernel.h"
+#include "scheduler.h"
+#include "solve_stats.h"
 
 
-// runs iterated greedy algorithm on the graph until a sigterm signal is received.
-// v->is_in_ds must be set to false for all vertices before calling this function.
+
+typedef enum IGParallelMode {
+    IG_PARALLEL_PORTFOLIO, // every thread searches on the whole kernel, the threads share their best solutions
+    IG_PARALLEL_PARTITION, // the kernel is partitioned, every thread improves a part of one shared solution
+} IGParallelMode;
+
+
+typedef struct IGConfig {
+    unsigned num_threads;         // must be at least 1
+    IGParallelMode parallel_mode; // irrelevant if num_threads == 1
+    size_t local_search_interval; // initially run a swap local search phase every x iterations, 0 to disable. Portfolio mode only.
+    bool consensus; // fix the vertices that are in all or in none of the recent best solutions of a worker, so that
+                    // the iterations only work on the contested rest, until they stall. Portfolio mode only.
+    uint64_t seed;                // the workers derive their random seeds from it
+    const bool* initial_ds; // k->n entries, the vertices to build the initial solution from (see ig_initial_construct), or NULL
+    SolveStats* stats;      // receives the improvements over time and the number of iterations, or NULL
+} IGConfig;
+
+
+
+// computes a dominating set of k with the greedy vote construction, which is also the initial solution
+// of the iterated greedy algorithm. It is written to in_ds, which must have space for k->n elements.
+// initial is an optional set of vertices to start from, see ig_initial_construct, and may be NULL.
+// If a stop is requested, the construction is completed trivially.
+// returns the number of vertices in the dominating set.
+size_t greedy_initial_solution(const Kernel* k, const bool* initial, const StopCondition* stop, bool* in_ds);
+
+
+
+// runs iterated greedy algorithm on the kernel until a stop is requested.
+// The best dominating set found is written to in_ds, which must have space for k->n elements.
 // returns the number of vertices in the dominating set.
-size_t iterated_greedy_solver(Graph* g);
+size_t iterated_greedy_solver(const Kernel* k, const IGConfig* config, const StopCondition* stop, bool* in_ds);
 
 
 
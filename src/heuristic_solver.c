@@ -1,65 +1,176 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
-#include <assert.h>
 #include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
 
-#include "graph.h"
-#include "reduction.h"
-#include "greedy.h"
-#include "debug_log.h"
+#include "ds_solver.h"
+#include "cli.h"
+#include "sigterm.h"
+#include "perf_counters.h"
+#include "kernel_cache.h"
+#include "verify.h"
+#include "solution_writer.h"
 
 
 
-static void _print_solution(Graph* g, size_t ds_size)
+// what is checked and reported besides the solution
+typedef struct ReportOptions {
+    const char* stats_path; // NULL if not requested
+    const char* trace_path;
+    const char* perf_path;
+    bool verify;
+} ReportOptions;
+
+
+
+static void _print_usage(FILE* stream, const char* program_name)
 {
-    assert(g != NULL && g->vertices != NULL && g->fixed.vertices != NULL);
-    printf("%zu\n", g->fixed.size + ds_size);
-    for(size_t fixed_idx = 0; fixed_idx < g->fixed.size; fixed_idx++) {
-        Vertex* v = g->fixed.vertices[fixed_idx];
-        printf("%" PRIu32 "\n", v->id);
-    }
-#ifndef NDEBUG
-    size_t ds_vertices_found_in_g = 0; // this variable is just for an assertion
-#endif
-    for(size_t i_vertices = 0; i_vertices < g->n; i_vertices++) {
-        Vertex* v = g->vertices[i_vertices];
-        if(v->is_in_ds) {
-            printf("%" PRIu32 "\n", v->id);
-#ifndef NDEBUG
-            ds_vertices_found_in_g++;
-#endif
+    fprintf(stream,
+            "Usage: %s [--time-limit S] [--initial FILE] [--cache DIR] [--export-kernel FILE] [--seed X] [--engine ig|cc] [--threads K] [--partition] [--local-search K] [--consensus] [--stats FILE] [--trace FILE] [--perf FILE] [--verify] < graph.gr > solution.ds\n",
+            program_name);
+    cli_print_solver_options(stream);
+    fprintf(stream, "  --stats FILE        write the measurements of the solve as JSON to FILE, or to stderr if FILE is -\n");
+    fprintf(stream, "  --trace FILE        write the convergence trace of the solve as tab separated lines to FILE, or to stderr if FILE is -\n");
+    fprintf(stream, "  --perf FILE         count cycles, instructions, cache, branch and TLB misses per phase with the hardware\n");
+    fprintf(stream, "                      performance counters and write them to FILE, or to stderr if FILE is -\n");
+    fprintf(stream, "  --verify            check the solution against the input graph before printing it (see verify_solution),\n");
+    fprintf(stream, "                      and exit with an error if it is not valid\n");
+    fprintf(stream, "  --help              print this help text\n");
+}
+
+
+
+static DSOptions _parse_options(int argc, char** argv, double* time_limit, ReportOptions* report)
+{
+    DSOptions options = ds_default_options();
+    options.seed = (uint64_t)time(NULL);
+    *time_limit = 0.0;
+    *report = (ReportOptions) {.stats_path = NULL, .trace_path = NULL, .perf_path = NULL, .verify = false};
+    for(int i = 1; i < argc; i++) {
+        if(cli_parse_solver_option(argc, argv, &i, &options, time_limit)) {
+            continue;
+        }
+        if(strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            report->stats_path = argv[++i];
+            continue;
         }
+        if(strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            report->trace_path = argv[++i];
+            options.record_trace = true;
+            continue;
+        }
+        if(strcmp(argv[i], "--perf") == 0 && i + 1 < argc) {
+            report->perf_path = argv[++i];
+            continue;
+        }
+        if(strcmp(argv[i], "--verify") == 0) {
+            report->verify = true;
+            continue;
+        }
+        if(strcmp(argv[i], "--help") == 0) {
+            _print_usage(stdout, argv[0]);
+            exit(EXIT_SUCCESS);
+        }
+        fprintf(stderr, "unknown or incomplete option '%s'\n", argv[i]);
+        _print_usage(stderr, argv[0]);
+        exit(EXIT_FAILURE);
     }
-    fflush(stdout);
-    assert(ds_vertices_found_in_g == ds_size);
+    return options;
 }
 
 
 
-int main(void)
+// open the file at path for writing, or return stderr if path is "-". Exits on failure.
+static FILE* _open_output(const char* path)
 {
-    Graph* g = graph_parse(stdin);
-    if(!g) {
+    FILE* file = strcmp(path, "-") == 0 ? stderr : fopen(path, "w");
+    if(!file) {
+        perror("opening the output file failed");
         exit(EXIT_FAILURE);
     }
+    return file;
+}
 
-    debug_log("starting reduction with g->n == %" PRIu32 ", g->m == %" PRIu32 "\n", g->n, g->m);
-    reduce(g, 13.0, 7.5); // 7.5 seconds to try all reduction rules including rule 2, then 5.5 more seconds to try rule 1 reductions
-    debug_log("finished reduction with g->n == %" PRIu32 ", g->m == %" PRIu32 ", g->fixed.size == %zu\n",
-              g->n, g->m, g->fixed.size);
 
-    if(g->n <= 3) {
-        if(g->n != 0) { // although extremely unlikely, it is possible that the whole graph can be reduced but the time budget ran out just before the last reduction step
-            reduce(g, 1.0, 1.0);
-        }
-        _print_solution(g, 0);
-        graph_free(g);
-        return EXIT_SUCCESS;
+
+// close a file opened by _open_output. Exits on failure.
+static void _close_output(FILE* file, bool write_success)
+{
+    if(!write_success || (file != stderr && fclose(file) != 0)) {
+        perror("writing the output file failed");
+        exit(EXIT_FAILURE);
     }
+}
+
+
 
-    size_t ds_size = iterated_greedy_solver(g);
-    _print_solution(g, ds_size);
-    graph_free(g);
-    return EXIT_SUCCESS;
+int main(int argc, char** argv)
+{
+    double time_limit;
+    ReportOptions report;
+    const DSOptions options = _parse_options(argc, argv, &time_limit, &report);
+    if(report.perf_path != NULL && !perf_counters_enable()) { // the solve is still useful without the counters
+        fprintf(stderr, "the performance counters are not available, --perf is ignored\n");
+        report.perf_path = NULL;
+    }
+    // from now on, every phase stops quickly on a sigterm, and the best solution found so far is printed
+    sigterm_register_handler();
+    DSSolver* solver = ds_solver_create();
+    if(!solver) {
+        perror("ds_solver_create failed");
+        exit(EXIT_FAILURE);
+    }
+    // the verification needs the input again after the solve, so it is kept in memory
+    InputBuffer input = {.data = NULL, .size = 0, .hash = 0, .check = 0};
+    FILE* input_stream = stdin;
+    if(report.verify) {
+        input = kernel_cache_read_input(stdin);
+        if(!input.data) { // the reason has been printed
+            exit(EXIT_FAILURE);
+        }
+        input_stream = fmemopen(input.data, input.size, "r");
+        if(!input_stream) {
+            perror("opening the input buffer failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    const DSResult result = ds_solve(solver, input_stream, &options, time_limit, sigterm_flag());
+    if(result.status != DS_STATUS_OK) { // the message has been printed
+        exit(EXIT_FAILURE);
+    }
+    bool is_valid = true;
+    if(report.verify) {
+        fclose(input_stream);
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        VerifyReport verify_report;
+        verify_solution(input.data, input.size, result.ids, result.size, result.size, cpus > 0 ? (unsigned)cpus : 1,
+                        &verify_report);
+        free(input.data);
+        is_valid = verify_report_is_valid(&verify_report);
+        if(!is_valid) {
+            fprintf(stderr, "the solution is not valid:\n");
+            verify_report_print(&verify_report, stderr);
+        }
+    }
+    if(!solution_write(STDOUT_FILENO, result.ids, result.size)) {
+        perror("writing the solution failed");
+        exit(EXIT_FAILURE);
+    }
+    // the stats and the trace come after the solution, which matters more if the time is up
+    if(report.stats_path != NULL) {
+        FILE* stats_file = _open_output(report.stats_path);
+        _close_output(stats_file, solve_stats_write_json(ds_solver_stats(solver), stats_file));
+    }
+    if(report.trace_path != NULL) {
+        FILE* trace_file = _open_output(report.trace_path);
+        _close_output(trace_file, trace_write(ds_solver_trace(solver), trace_file));
+    }
+    if(report.perf_path != NULL) {
+        FILE* perf_file = _open_output(report.perf_path);
+        _close_output(perf_file, perf_counters_write(perf_file));
+    }
+    ds_solver_free(solver);
+    return is_valid ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,708 @@
+#include "ig_state.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "assert_allow_float_equal.h"
+#include "debug_log.h"
+#include "alloc_counter.h"
+#include "perf_counters.h"
+
+
+
+#define IG_START_SAMPLES 16 // the hub and redundant deconstructions start at the best of x random vertices
+#define IG_STOP_CHECK_INTERVAL 1024 // the greedy construction checks for a stop request after adding x vertices
+#define IG_RANDOM_BLOCK_SIZE 256 // the random deconstruction generates random numbers for x vertices at once, must be a multiple of FAST_RANDOM_LANES
+
+
+
+// the i-th vertex of the region of s
+static inline uint32_t _region_vertex(const IGState* s, uint32_t i)
+{
+    assert(i < s->region_size);
+    return s->region != NULL ? s->region[i] : i;
+}
+
+
+
+// whether s may add v to the ds or remove it from the ds
+static inline bool _is_candidate(const IGState* s, uint32_t v)
+{
+    return s->is_candidate == NULL || s->is_candidate[v];
+}
+
+
+
+// the name of the operator in the stats and traces of a solve, e.g. "random" for IG_OP_RANDOM
+const char* ig_operator_name(IGOperator op)
+{
+    static const char* const names[IG_NUM_OPERATORS] = {"random", "local", "radius_1", "radius_2", "hub", "redundant"};
+    assert(op < IG_NUM_OPERATORS);
+    return names[op];
+}
+
+
+
+// the votes are the same for every state, so they are only computed once
+// caller is responsible for freeing the returned array
+double* ig_new_votes(const Kernel* k)
+{
+    assert(k != NULL);
+    double* votes = malloc(((size_t)k->n + 1) * sizeof(double));
+    if(!votes) {
+        perror("ig_new_votes: malloc failed");
+        exit(EXIT_FAILURE);
+    }
+    for(uint32_t v = 0; v < k->n; v++) {
+        votes[v] = 1.0 / (double)(kernel_degree(k, v) + 1);
+    }
+    return votes;
+}
+
+
+
+// (the analyzer cannot tell that the states of different workers do not alias and reports false leaks)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wanalyzer-malloc-leak"
+void ig_state_init(IGState* s, const Kernel* k, const double* votes, const IGState* shared, uint64_t seed,
+                   double strength_factor, const StopCondition* stop)
+{
+    assert(s != NULL && k != NULL && votes != NULL);
+    const size_t n = (size_t)k->n + 1; // + 1 to avoid malloc(0)
+    s->k = k;
+    s->votes = votes;
+    s->stop = stop;
+    if(shared == NULL) {
+        s->owns_solution = true;
+        s->dominated_by_number = malloc(n * sizeof(uint32_t));
+        s->is_in_ds = calloc(n, sizeof(bool));
+        s->saved_dominated_by_number = malloc(n * sizeof(uint32_t));
+        s->saved_is_in_ds = calloc(n, sizeof(bool));
+        if(!s->dominated_by_number || !s->is_in_ds || !s->saved_dominated_by_number || !s->saved_is_in_ds) {
+            perror("ig_state_init: allocating the solution arrays failed");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(s->dominated_by_number, k->dominated_by_fixed, (size_t)k->n * sizeof(uint32_t));
+        memcpy(s->saved_dominated_by_number, k->dominated_by_fixed, (size_t)k->n * sizeof(uint32_t));
+        s->current_ds_size = 0;
+        s->saved_ds_size = 0;
+    }
+    else {
+        s->owns_solution = false;
+        s->dominated_by_number = shared->dominated_by_number;
+        s->is_in_ds = shared->is_in_ds;
+        s->saved_dominated_by_number = shared->saved_dominated_by_number;
+        s->saved_is_in_ds = shared->saved_is_in_ds;
+        s->current_ds_size = shared->current_ds_size;
+        s->saved_ds_size = shared->saved_ds_size;
+    }
+    s->region = NULL;
+    s->region_size = k->n;
+    s->is_candidate = NULL;
+    s->queued = calloc(n, sizeof(uint32_t));
+    s->bfs_queue = (Queue) {.elems = malloc(n * sizeof(uint32_t)), .head = 0, .tail = 0};
+    s->pq = pq_new(k->n);
+    if(!s->queued || !s->bfs_queue.elems || !s->pq) {
+        perror("ig_state_init: allocating the working memory failed");
+        exit(EXIT_FAILURE);
+    }
+    s->queued_current_marker = 0;
+    fast_random_init(&(s->rng), seed);
+    fast_random_bulk_init(&(s->bulk_rng), fast_random(&(s->rng)));
+    s->local_max_removals = (size_t)(40.0 * strength_factor + 0.5); // max removals can be tweaked
+    s->local_max_removals = s->local_max_removals > 0 ? s->local_max_removals : 1;
+    s->random_removal_probability = 0.006 * strength_factor; // removal probability can be tweaked
+    for(int op = 0; op < IG_NUM_OPERATORS; op++) {
+        s->operators[op] = (IGOperatorStats) {.reward = 0.5, .seconds = 0.0, .strength = 1.0};
+        s->counters[op] = (IGOperatorCounters) {0};
+    }
+    s->last_operator = IG_OP_RANDOM;
+    s->operators[IG_OP_RANDOM].reward = 1.0; // Testing has shown that random deconstruction is better in the beginning, so make sure to prioritize it initially
+}
+#pragma GCC diagnostic pop
+
+
+
+void ig_state_free(IGState* s)
+{
+    assert(s != NULL);
+    if(s->owns_solution) {
+        free(s->dominated_by_number);
+        free(s->is_in_ds);
+        free(s->saved_dominated_by_number);
+        free(s->saved_is_in_ds);
+    }
+    s->dominated_by_number = NULL;
+    s->is_in_ds = NULL;
+    s->saved_dominated_by_number = NULL;
+    s->saved_is_in_ds = NULL;
+    free(s->queued);
+    free(s->bfs_queue.elems);
+    pq_free(s->pq);
+}
+
+
+
+// restrict s to the vertices in region, see IGState. Counts the ds vertices in the region.
+// The solution of s must be saved, i.e. the current solution equals the saved one.
+void ig_state_set_region(IGState* s, const uint32_t* region, uint32_t region_size, const bool* is_candidate)
+{
+    assert(s != NULL && region != NULL && is_candidate != NULL && region_size > 0);
+    s->region = region;
+    s->region_size = region_size;
+    s->is_candidate = is_candidate;
+    size_t count_ds = 0;
+    for(uint32_t i = 0; i < region_size; i++) {
+        assert(s->is_in_ds[region[i]] == s->saved_is_in_ds[region[i]]);
+        count_ds += s->is_in_ds[region[i]];
+    }
+    s->current_ds_size = count_ds;
+    s->saved_ds_size = count_ds;
+}
+
+
+
+// lift the restriction of s to a region. Counts the ds vertices in the whole kernel.
+// The solution of s must be saved, i.e. the current solution equals the saved one.
+void ig_state_clear_region(IGState* s)
+{
+    assert(s != NULL);
+    s->region = NULL;
+    s->region_size = s->k->n;
+    s->is_candidate = NULL;
+    size_t count_ds = 0;
+    for(uint32_t v = 0; v < s->k->n; v++) {
+        assert(s->is_in_ds[v] == s->saved_is_in_ds[v]);
+        count_ds += s->is_in_ds[v];
+    }
+    s->current_ds_size = count_ds;
+    s->saved_ds_size = count_ds;
+}
+
+
+
+// return the new ds size
+static size_t _make_minimal(IGState* s, size_t current_ds_size)
+{
+    assert(s != NULL);
+    const Kernel* k = s->k;
+    for(uint32_t i = 0; i < s->region_size; i++) {
+        uint32_t v = _region_vertex(s, i);
+        if(s->is_in_ds[v] && s->dominated_by_number[v] > 1 && _is_candidate(s, v)) {
+            bool v_redundant = true;
+            uint32_t u;
+            for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+                if(s->dominated_by_number[u] < 2) {
+                    assert(s->dominated_by_number[u] >= 1); // otherwise ds would not be a dominating set
+                    v_redundant = false;
+                    break;
+                }
+            }
+            if(v_redundant) {
+                s->is_in_ds[v] = false;
+                current_ds_size--;
+                s->dominated_by_number[v]--;
+                for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+                    s->dominated_by_number[u]--;
+                }
+            }
+        }
+    }
+    return current_ds_size;
+}
+
+
+
+// must only be called if v is currently in the ds.
+static inline void _remove_from_ds(IGState* s, uint32_t v)
+{
+    assert(s->is_in_ds[v]);
+    const Kernel* k = s->k;
+    s->dominated_by_number[v]--;
+    uint32_t u;
+    for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+        s->dominated_by_number[u]--;
+    }
+    s->is_in_ds[v] = false;
+}
+
+
+
+// returns the resulting ds size
+static size_t _random_deconstruction(IGState* s, double removal_probability, size_t current_ds_size)
+{
+    const uint64_t rand_threshold = (uint64_t)(removal_probability * (double)FAST_RANDOM_MAX);
+    uint64_t randoms[IG_RANDOM_BLOCK_SIZE]; // generated in bulk, one for each vertex of the block
+    for(uint32_t block_start = 0; block_start < s->region_size; block_start += IG_RANDOM_BLOCK_SIZE) {
+        const uint32_t block_size = s->region_size - block_start < IG_RANDOM_BLOCK_SIZE ?
+                                        s->region_size - block_start :
+                                        IG_RANDOM_BLOCK_SIZE;
+        fast_random_fill(&s->bulk_rng, randoms, IG_RANDOM_BLOCK_SIZE);
+        for(uint32_t i = 0; i < block_size; i++) {
+            uint32_t v = _region_vertex(s, block_start + i);
+            if(randoms[i] < rand_threshold && s->is_in_ds[v] && _is_candidate(s, v)) {
+                _remove_from_ds(s, v);
+                current_ds_size--;
+            }
+        }
+    }
+    return current_ds_size;
+}
+
+
+
+static inline bool _queue_is_empty(const Queue* q)
+{
+    return q->head == q->tail;
+}
+
+static inline void _enqueue(Queue* q, uint32_t new_val)
+{
+    q->elems[q->tail++] = new_val;
+}
+
+static inline uint32_t _dequeue(Queue* q)
+{
+    assert(!_queue_is_empty(q));
+    return q->elems[q->head++];
+}
+
+static inline void _clear_queue(Queue* q)
+{
+    q->head = 0;
+    q->tail = 0;
+}
+
+
+
+// a random vertex of the region of s
+static inline uint32_t _random_region_vertex(IGState* s)
+{
+    uint32_t index = (uint32_t)(((__uint128_t)s->region_size * (__uint128_t)fast_random(&s->rng)) /
+                                ((__uint128_t)FAST_RANDOM_MAX + 1));
+    return _region_vertex(s, index);
+}
+
+
+
+// the vertex with the highest key among IG_START_SAMPLES random vertices of the region
+static uint32_t _sampled_start(IGState* s, bool by_degree)
+{
+    uint32_t best = _random_region_vertex(s);
+    for(int sample = 1; sample < IG_START_SAMPLES; sample++) {
+        uint32_t v = _random_region_vertex(s);
+        if(by_degree ? kernel_degree(s->k, v) > kernel_degree(s->k, best) :
+                       s->dominated_by_number[v] > s->dominated_by_number[best]) {
+            best = v;
+        }
+    }
+    return best;
+}
+
+
+
+// create a local hole in the ds coverage using breadth-first search from start. It removes the ds vertices
+// closest to start, but at most max_removals and only those within distance max_distance.
+// if s is restricted to a region, the BFS only visits candidates, which keeps it inside the region
+// returns the resulting ds size
+static size_t _local_deconstruction(IGState* s, uint32_t start, size_t max_removals, uint32_t max_distance,
+                                    size_t current_ds_size)
+{
+    const Kernel* k = s->k;
+    if(!_is_candidate(s, start)) {
+        return current_ds_size;
+    }
+    s->queued_current_marker++;
+    // the queued array is used like a bool array. However, to avoid having to reset all queued
+    // entries to false, the next local deconstruction run increments queued_current_marker and
+    // checks the queued entries against a new value.
+
+    Queue* q = &(s->bfs_queue);
+    _clear_queue(q);
+    s->queued[start] = s->queued_current_marker;
+    _enqueue(q, start);
+    size_t count_removed = 0;
+    size_t ds_vertices_queued = 0;
+    uint32_t distance = 0;        // the distance of the vertices that are dequeued next
+    size_t distance_end = q->tail; // the queue index at which the vertices of the next distance begin
+    while((!_queue_is_empty(q)) && count_removed < max_removals) {
+        if(q->head == distance_end) {
+            distance++;
+            distance_end = q->tail;
+        }
+        uint32_t v = _dequeue(q);
+        if(s->is_in_ds[v]) {
+            _remove_from_ds(s, v);
+            count_removed++;
+        }
+        if(distance == max_distance) {
+            continue;
+        }
+        // enqueue neighbors of v if not already enqueued / visited
+        uint32_t u;
+        for(KernelNeighbors it = kernel_neighbors(k, v);
+            ds_vertices_queued < max_removals && kernel_next_neighbor(&it, &u);) {
+            if(s->queued[u] != s->queued_current_marker && _is_candidate(s, u)) {
+                s->queued[u] = s->queued_current_marker;
+                _enqueue(q, u);
+                if(s->is_in_ds[u]) {
+                    ds_vertices_queued++;
+                }
+            }
+        }
+    }
+    return current_ds_size - count_removed;
+}
+
+
+
+// deconstruct the solution of s with operator op
+// returns the resulting ds size
+static size_t _deconstruction(IGState* s, IGOperator op, size_t current_ds_size)
+{
+    const double strength = s->operators[op].strength;
+    size_t max_removals = (size_t)((double)s->local_max_removals * strength + 0.5);
+    max_removals = max_removals > 0 ? max_removals : 1;
+    switch(op) {
+        case IG_OP_RANDOM:
+            return _random_deconstruction(s, s->random_removal_probability * strength, current_ds_size);
+        case IG_OP_LOCAL:
+            return _local_deconstruction(s, _random_region_vertex(s), max_removals, UINT32_MAX, current_ds_size);
+        case IG_OP_RADIUS_1:
+            return _local_deconstruction(s, _random_region_vertex(s), max_removals, 1, current_ds_size);
+        case IG_OP_RADIUS_2:
+            return _local_deconstruction(s, _random_region_vertex(s), max_removals, 2, current_ds_size);
+        case IG_OP_HUB:
+            return _local_deconstruction(s, _sampled_start(s, true), max_removals, UINT32_MAX, current_ds_size);
+        case IG_OP_REDUNDANT:
+            return _local_deconstruction(s, _sampled_start(s, false), max_removals, UINT32_MAX, current_ds_size);
+        case IG_NUM_OPERATORS:
+        default:
+            assert(false);
+            return current_ds_size;
+    }
+}
+
+
+
+// for every undominated vertex of the region, add the candidate of highest degree in its closed neighborhood
+// to the ds. Worse than the greedy construction, but it takes only O(n + m).
+// returns the resulting ds size
+static size_t _trivial_construct(IGState* s, size_t current_ds_size)
+{
+    const Kernel* k = s->k;
+    for(uint32_t i = 0; i < s->region_size; i++) {
+        uint32_t v = _region_vertex(s, i);
+        if(s->dominated_by_number[v] > 0) {
+            continue;
+        }
+        uint32_t u = v;
+        uint32_t w;
+        for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &w);) {
+            if(_is_candidate(s, w) && (!_is_candidate(s, u) || kernel_degree(k, w) > kernel_degree(k, u))) {
+                u = w;
+            }
+        }
+        assert(_is_candidate(s, u) && !s->is_in_ds[u]);
+        s->is_in_ds[u] = true;
+        current_ds_size++;
+        s->dominated_by_number[u]++;
+        uint32_t x;
+        for(KernelNeighbors it = kernel_neighbors(k, u); kernel_next_neighbor(&it, &x);) {
+            s->dominated_by_number[x]++;
+        }
+    }
+    return current_ds_size;
+}
+
+
+
+// construct a dominating set greedily from the current partial solution and make it minimal.
+// If a stop is requested, the rest is constructed trivially, so that a valid solution is available quickly.
+// returns the resulting ds size
+size_t ig_greedy_vote_construct(IGState* s, size_t current_ds_size)
+{
+    const Kernel* k = s->k;
+    const double* votes = s->votes;
+    uint32_t* dominated_by_number = s->dominated_by_number;
+    PQueue* pq = s->pq;
+    assert(pq_is_empty(pq));
+    uint32_t undominated_vertices = 0; // the total number of undominated vertices remaining in the region
+
+    for(uint32_t i = 0; i < s->region_size; i++) {
+        uint32_t v = _region_vertex(s, i);
+        double weight = 0.0; // aka votes received
+        if(dominated_by_number[v] == 0) {
+            undominated_vertices++;
+            weight = votes[v];
+        }
+        if(!_is_candidate(s, v)) {
+            continue;
+        }
+        uint32_t u;
+        for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+            if(dominated_by_number[u] == 0) {
+                weight += votes[u];
+            }
+        }
+        if(weight > 0.0) {
+            pq_insert(pq, (KeyValPair) {.key = weight, .val = v});
+        }
+    }
+
+
+    for(size_t count_added = 0; undominated_vertices > 0; count_added++) {
+        if(count_added % IG_STOP_CHECK_INTERVAL == IG_STOP_CHECK_INTERVAL - 1 && stop_requested(s->stop)) {
+            current_ds_size = _trivial_construct(s, current_ds_size);
+            break;
+        }
+        assert(!pq_is_empty(pq));
+        KeyValPair kv = pq_pop(pq);
+        uint32_t v = kv.val;
+        assert(!s->is_in_ds[v]);
+        s->is_in_ds[v] = true;
+        current_ds_size++;
+        double v_is_newly_dominated = 0.0;
+        dominated_by_number[v]++;
+        if(dominated_by_number[v] == 1) {
+            v_is_newly_dominated = 1.0;
+            undominated_vertices--;
+        }
+
+        uint32_t u1;
+        for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u1);) {
+            dominated_by_number[u1]++;
+            double delta_weight_u1 = v_is_newly_dominated * votes[v];
+            if(dominated_by_number[u1] == 1) { // if v is the first one to dominate u1
+                delta_weight_u1 += votes[u1];  // u1 no longer votes for itself
+                undominated_vertices--;
+                for(size_t i_u1 = k->offsets[u1]; i_u1 < k->offsets[u1 + 1]; i_u1++) {
+                    uint32_t u2 = k->adjacency[i_u1];
+                    // because u1 is now dominated, u2 no longer receives u1's vote
+                    if(pq_contains(pq, u2)) {
+                        pq_decrease_priority(pq, u2, pq_get_key(pq, u2) - votes[u1]);
+                    }
+                }
+            }
+            if(pq_contains(pq, u1) && delta_weight_u1 > 0) {
+                pq_decrease_priority(pq, u1, pq_get_key(pq, u1) - delta_weight_u1);
+            }
+        }
+    }
+    pq_clear(pq); // keep the allocated space for the next construction
+    current_ds_size = _make_minimal(s, current_ds_size);
+    return current_ds_size;
+}
+
+
+
+// construct the initial solution of s, which must be unrestricted and hold the empty ds.
+// If initial is not NULL, a solution is first completed from the vertices v with initial[v] with
+// ig_greedy_vote_construct, which also removes the initial vertices that turn out to be redundant. Then,
+// unless a stop has been requested, a second solution is constructed from the empty ds, and the smaller
+// one is kept. This way, a good initial set is used, but a bad one never makes the start worse.
+// Both the current and the saved solution of s are set to the result.
+// returns the resulting ds size
+size_t ig_initial_construct(IGState* s, const bool* initial)
+{
+    const Kernel* k = s->k;
+    assert(s->region == NULL && s->current_ds_size == 0);
+    if(initial != NULL) {
+        size_t current_ds_size = 0;
+        for(uint32_t v = 0; v < k->n; v++) {
+            if(initial[v]) {
+                s->is_in_ds[v] = true;
+                current_ds_size++;
+                s->dominated_by_number[v]++;
+                uint32_t u;
+                for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+                    s->dominated_by_number[u]++;
+                }
+            }
+        }
+        s->current_ds_size = ig_greedy_vote_construct(s, current_ds_size);
+        ig_save_solution(s);
+        if(stop_requested(s->stop)) {
+            return s->current_ds_size;
+        }
+        memcpy(s->dominated_by_number, k->dominated_by_fixed, (size_t)k->n * sizeof(uint32_t));
+        memset(s->is_in_ds, 0, (size_t)k->n * sizeof(bool));
+    }
+    s->current_ds_size = ig_greedy_vote_construct(s, 0);
+    if(initial != NULL && s->current_ds_size >= s->saved_ds_size) {
+        ig_restore_solution(s);
+    }
+    else {
+        ig_save_solution(s);
+    }
+    return s->current_ds_size;
+}
+
+
+
+// save the current solution of s as the best one (only the region, if s is restricted)
+void ig_save_solution(IGState* s)
+{
+    if(s->region == NULL) {
+        memcpy(s->saved_dominated_by_number, s->dominated_by_number, (size_t)s->k->n * sizeof(uint32_t));
+        memcpy(s->saved_is_in_ds, s->is_in_ds, (size_t)s->k->n * sizeof(bool));
+    }
+    else {
+        for(uint32_t i = 0; i < s->region_size; i++) {
+            uint32_t v = s->region[i];
+            s->saved_dominated_by_number[v] = s->dominated_by_number[v];
+            s->saved_is_in_ds[v] = s->is_in_ds[v];
+        }
+    }
+    s->saved_ds_size = s->current_ds_size;
+}
+
+
+
+// replace the current solution of s by the saved one (only the region, if s is restricted)
+void ig_restore_solution(IGState* s)
+{
+    if(s->region == NULL) {
+        memcpy(s->dominated_by_number, s->saved_dominated_by_number, (size_t)s->k->n * sizeof(uint32_t));
+        memcpy(s->is_in_ds, s->saved_is_in_ds, (size_t)s->k->n * sizeof(bool));
+    }
+    else {
+        for(uint32_t i = 0; i < s->region_size; i++) {
+            uint32_t v = s->region[i];
+            s->dominated_by_number[v] = s->saved_dominated_by_number[v];
+            s->is_in_ds[v] = s->saved_is_in_ds[v];
+        }
+    }
+    s->current_ds_size = s->saved_ds_size;
+}
+
+
+
+static inline double _clamp(double x, double min, double max)
+{
+    return (x < min) ? min : (x > max) ? max : x;
+}
+
+
+
+// cpu time used by the calling thread in seconds
+static double _thread_cpu_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + 1.e-9 * (double)ts.tv_nsec;
+}
+
+
+
+// Choose the deconstruction operator for the next iteration. Every operator is tried once first. Then the
+// probability of each operator is minimum_probability plus a share of the rest that is proportional to
+// its rate, the reward per cpu second. Cheap operators are therefore preferred if they work equally well.
+static IGOperator _choose_operator(IGState* s, double minimum_probability)
+{
+    double rates[IG_NUM_OPERATORS];
+    double rates_sum = 0.0;
+    for(int op = 0; op < IG_NUM_OPERATORS; op++) {
+        if(s->operators[op].seconds <= 0.0) {
+            return (IGOperator)op;
+        }
+        rates[op] = s->operators[op].reward / s->operators[op].seconds;
+        rates_sum += rates[op];
+    }
+    const double shared_probability = 1.0 - IG_NUM_OPERATORS * minimum_probability;
+    const uint64_t random = fast_random(&s->rng);
+    double r = (double)random / (double)FAST_RANDOM_MAX;
+    for(int op = 0; op < IG_NUM_OPERATORS - 1; op++) {
+        double probability = minimum_probability + (rates_sum > 0.0 ? shared_probability * rates[op] / rates_sum :
+                                                                      shared_probability / IG_NUM_OPERATORS);
+        if(r < probability) {
+            return (IGOperator)op;
+        }
+        r -= probability;
+    }
+    return (IGOperator)(IG_NUM_OPERATORS - 1);
+}
+
+
+
+// one iteration of iterated greedy: deconstruct the solution with one of the deconstruction operators,
+// reconstruct it greedily, and keep it if it is not worse than the saved solution.
+// The operator is chosen by a bandit that prefers the operators with the most improvements per cpu second.
+// returns true iff the saved solution was improved
+bool ig_iteration(IGState* s, size_t iteration)
+{
+#ifdef DEBUG_LOG
+    const size_t allocations_before_iteration = alloc_counter_get();
+#endif
+    // these metaheuristic values can be tweaked for optimal results and performance
+    const double score_decay_factor = 0.9; // must be >0 and <1
+    const double reward_improvement = 1.0;
+    const double reward_equal = 0.0;         // should be >=0 and <=reward_improvement
+    const double minimum_probability = 0.04; // the minimal probability for an operator to be selected, regardless of how low its rate is. Must be >=0 and <=1/IG_NUM_OPERATORS
+    const double strength_step = 1.03;       // the factor by which the strength of an operator is adapted
+    const double min_strength = 0.25;
+    const double max_strength = 4.0;
+
+    const IGOperator op = _choose_operator(s, minimum_probability);
+    s->last_operator = op;
+    IGOperatorStats* stats = &(s->operators[op]);
+    debug_log("operator %d (reward == %.6f  seconds == %.6f  strength == %.3f)\t", (int)op, stats->reward,
+              stats->seconds, stats->strength);
+    const double start_seconds = _thread_cpu_seconds();
+    perf_phase_begin(PERF_PHASE_DECONSTRUCT);
+    s->current_ds_size = _deconstruction(s, op, s->current_ds_size);
+    perf_phase_end(PERF_PHASE_DECONSTRUCT);
+    const double construct_start_seconds = _thread_cpu_seconds();
+    perf_phase_begin(PERF_PHASE_CONSTRUCT);
+    s->current_ds_size = ig_greedy_vote_construct(s, s->current_ds_size);
+    perf_phase_end(PERF_PHASE_CONSTRUCT);
+    const double end_seconds = _thread_cpu_seconds();
+    const double seconds = end_seconds - start_seconds;
+    IGOperatorCounters* counters = &(s->counters[op]);
+    counters->iterations++;
+    counters->deconstruct_seconds += construct_start_seconds - start_seconds;
+    counters->construct_seconds += end_seconds - construct_start_seconds;
+    if(s->current_ds_size < s->saved_ds_size) {
+        counters->improvements++;
+    }
+    else if(s->current_ds_size == s->saved_ds_size) {
+        counters->equal_moves++;
+    }
+
+    double reward = s->current_ds_size < s->saved_ds_size  ? reward_improvement :
+                    s->current_ds_size == s->saved_ds_size ? reward_equal :
+                                                             0.0;
+    stats->reward = stats->reward * score_decay_factor + reward;
+    stats->seconds = stats->seconds * score_decay_factor + (seconds > 1.e-9 ? seconds : 1.e-9);
+    // a worse solution means that the operator destroyed too much to be repaired, and an equal one that it
+    // is stuck on a plateau and should destroy more
+    if(s->current_ds_size > s->saved_ds_size) {
+        stats->strength = _clamp(stats->strength / strength_step, min_strength, max_strength);
+    }
+    else if(s->current_ds_size == s->saved_ds_size) {
+        stats->strength = _clamp(stats->strength * strength_step, min_strength, max_strength);
+    }
+
+    bool improvement = s->current_ds_size < s->saved_ds_size;
+    if(s->current_ds_size <= s->saved_ds_size) {
+        debug_log("%s current_ds_size == %zu\tsaved_ds_size == %zu\t\tig_iteration == %zu\n",
+                  improvement ? "IMPROVEMENT:" : "EQUAL: =    ", s->current_ds_size, s->saved_ds_size, iteration);
+        ig_save_solution(s);
+    }
+    else { // restore saved solution
+        debug_log("worse:       current_ds_size == %zu\tsaved_ds_size == %zu\t\tig_iteration == %zu\n",
+                  s->current_ds_size, s->saved_ds_size, iteration);
+        ig_restore_solution(s);
+    }
+#ifdef DEBUG_LOG
+    const size_t allocations_in_iteration = alloc_counter_get() - allocations_before_iteration;
+    debug_log("heap allocations and frees in ig_iteration %zu == %zu\n", iteration, allocations_in_iteration);
+    assert(allocations_in_iteration == 0);
+#else
+    (void)iteration; // only used for logging
+#endif
+    return improvement;
+}
@@ -0,0 +1,165 @@
+#ifndef _IG_STATE_H
+#define _IG_STATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kernel.h"
+#include "pqueue.h"
+#include "fast_random.h"
+#include "scheduler.h"
+
+
+
+// BFS queue for the local deconstruction. Every vertex is enqueued at most once per BFS run, so an
+// array with space for k->n elements is sufficient and never has to wrap around or grow.
+// It is allocated once and reused for every run.
+typedef struct Queue {
+    uint32_t* elems;
+    size_t head; // index of the next element to dequeue
+    size_t tail; // index at which the next element will be enqueued
+} Queue;
+
+
+
+// The deconstruction operators of the iterated greedy search. Each iteration chooses one of them, see ig_iteration.
+typedef enum IGOperator {
+    IG_OP_RANDOM,    // remove every ds vertex with a small probability
+    IG_OP_LOCAL,     // remove the ds vertices closest to a random vertex, up to a maximum number
+    IG_OP_RADIUS_1,  // like IG_OP_LOCAL, but only within distance 1 of the start vertex
+    IG_OP_RADIUS_2,  // like IG_OP_LOCAL, but only within distance 2 of the start vertex
+    IG_OP_HUB,       // like IG_OP_LOCAL, starting at a vertex of high degree
+    IG_OP_REDUNDANT, // like IG_OP_LOCAL, starting at a vertex that is dominated many times
+    IG_NUM_OPERATORS
+} IGOperator;
+
+
+
+// the name of the operator in the stats and traces of a solve, e.g. "random" for IG_OP_RANDOM
+const char* ig_operator_name(IGOperator op);
+
+
+
+// what a state has learned about one deconstruction operator
+typedef struct IGOperatorStats {
+    double reward;   // exponentially decaying sum of the rewards of the iterations that used the operator
+    double seconds;  // exponentially decaying sum of the cpu time of these iterations, 0 if never used
+    double strength; // factor for the number of removals, adapted to the results of the operator
+} IGOperatorStats;
+
+
+// what one deconstruction operator did, for the stats of the solve (see solve_stats.h). Never decays.
+typedef struct IGOperatorCounters {
+    uint64_t iterations;
+    uint64_t improvements;
+    uint64_t equal_moves;       // iterations that ended with a solution of the same size, which is kept
+    double deconstruct_seconds; // cpu time
+    double construct_seconds;   // cpu time of the greedy reconstruction
+} IGOperatorCounters;
+
+
+
+// The mutable state of one iterated greedy search. Every worker has its own, while the kernel and
+// the votes are shared between all workers and never changed.
+// A state can be restricted to a region of the kernel. It then only adds or removes vertices v with
+// is_candidate[v], and only ensures that the vertices of the region are dominated. All candidates and
+// their neighbors must be in the region, so that states with disjoint regions can work on the same
+// solution arrays concurrently.
+typedef struct IGState {
+    const Kernel* k;
+    const double* votes;           // the vote of each vertex, 1 / (degree + 1)
+    const StopCondition* stop;     // the greedy construction completes the solution trivially once a stop is requested
+    uint32_t* dominated_by_number; // the number of vertices in the closed neighborhood in the ds, including fixed ones
+    bool* is_in_ds;                // saves if this vertex has been chosen for the dominating set in the current solution
+    uint32_t* saved_dominated_by_number; // dominated_by_number of the best solution found so far
+    bool* saved_is_in_ds;                // is_in_ds of the best solution found so far
+    bool owns_solution;   // whether the four arrays above were allocated by this state
+    const uint32_t* region; // the vertices of the region, NULL if the state is not restricted
+    uint32_t region_size;   // number of elements in region, or k->n if region is NULL
+    const bool* is_candidate; // NULL if the state is not restricted
+    size_t current_ds_size; // number of ds vertices in the region (or in the kernel if not restricted)
+    size_t saved_ds_size;   // the size of the ds saved in saved_dominated_by_number and saved_is_in_ds
+    uint32_t* queued; // used by local deconstruction to check if a vertex has been queued in the current BFS run yet
+    uint32_t queued_current_marker;
+    Queue bfs_queue;
+    PQueue* pq;
+    fast_random_t rng;
+    fast_random_bulk_t bulk_rng; // for the random deconstruction, which needs a random number per vertex
+    size_t local_max_removals;         // max removals of the local deconstructions at strength 1
+    double random_removal_probability; // removal probability of the random deconstruction at strength 1
+    IGOperatorStats operators[IG_NUM_OPERATORS];
+    IGOperatorCounters counters[IG_NUM_OPERATORS];
+    IGOperator last_operator; // the operator of the last iteration
+} IGState;
+
+
+
+// the votes are the same for every state, so they are only computed once
+// caller is responsible for freeing the returned array
+double* ig_new_votes(const Kernel* k);
+
+
+
+// Allocates all memory the search needs, so that the iterations themselves do not need to allocate or
+// free anything. If shared is NULL, s gets its own solution arrays which are initialized with the
+// empty ds. Otherwise, s works on the solution arrays of shared.
+// strength_factor scales the default deconstruction parameters. stop must stay valid while s is used.
+void ig_state_init(IGState* s, const Kernel* k, const double* votes, const IGState* shared, uint64_t seed,
+                   double strength_factor, const StopCondition* stop);
+
+
+
+void ig_state_free(IGState* s);
+
+
+
+// restrict s to the vertices in region, see IGState. Counts the ds vertices in the region.
+// The solution of s must be saved, i.e. the current solution equals the saved one.
+void ig_state_set_region(IGState* s, const uint32_t* region, uint32_t region_size, const bool* is_candidate);
+
+
+
+// lift the restriction of s to a region. Counts the ds vertices in the whole kernel.
+// The solution of s must be saved, i.e. the current solution equals the saved one.
+void ig_state_clear_region(IGState* s);
+
+
+
+// construct a dominating set greedily from the current partial solution and make it minimal.
+// If a stop is requested, the rest is constructed trivially, so that a valid solution is available quickly.
+// returns the resulting ds size
+size_t ig_greedy_vote_construct(IGState* s, size_t current_ds_size);
+
+
+
+// construct the initial solution of s, which must be unrestricted and hold the empty ds.
+// If initial is not NULL, a solution is first completed from the vertices v with initial[v] with
+// ig_greedy_vote_construct, which also removes the initial vertices that turn out to be redundant. Then,
+// unless a stop has been requested, a second solution is constructed from the empty ds, and the smaller
+// one is kept. This way, a good initial set is used, but a bad one never makes the start worse.
+// Both the current and the saved solution of s are set to the result.
+// returns the resulting ds size
+size_t ig_initial_construct(IGState* s, const bool* initial);
+
+
+
+// save the current solution of s as the best one (only the region, if s is restricted)
+void ig_save_solution(IGState* s);
+
+
+
+// replace the current solution of s by the saved one (only the region, if s is restricted)
+void ig_restore_solution(IGState* s);
+
+
+
+// one iteration of iterated greedy: deconstruct the solution with one of the deconstruction operators,
+// reconstruct it greedily, and keep it if it is not worse than the saved solution.
+// The operator is chosen by a bandit that prefers the operators with the most improvements per cpu second.
+// returns true iff the saved solution was improved
+bool ig_iteration(IGState* s, size_t iteration);
+
+
+
+#endif
@@ -0,0 +1,556 @@
+#include "kernel.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+
+
+#define KERNEL_PARSE_PASSES              16 // kernel_parse gathers the neighbor lists in at most about x passes
+#define KERNEL_PARSE_MIN_BLOCK           (1 << 20) // but in blocks of at least x neighbors
+#define KERNEL_PARSE_STOP_CHECK_INTERVAL 65536 // check for a stop request after every x edges
+#define KERNEL_FIXUP_STOP_CHECK_INTERVAL 4096 // and after every x vertices of the streaming ds fixup
+#define MAX_VARINT_LENGTH 5 // bytes of a varint of at most 35 bits, enough for all degrees and differences
+#define MAX_EDGE_LENGTH   (2 * MAX_VARINT_LENGTH) // bytes of an edge in the edge stream of kernel_parse
+
+
+
+// allocate a kernel with n vertices, m edges and fixed_count fixed vertices. Only the sizes are set, the
+// contents of the arrays are uninitialized, and the neighbors are added with kernel_add_neighbors.
+// Returns NULL if not successful.
+// caller is responsible for freeing using kernel_free(...)
+Kernel* kernel_new(uint32_t n, uint64_t m, size_t fixed_count)
+{
+    Kernel* k = calloc(1, sizeof(Kernel));
+    if(!k) {
+        return NULL;
+    }
+    k->n = n;
+    k->m = m;
+    k->fixed_count = fixed_count;
+#ifdef KERNEL_COMPRESSED
+    // a guess of 2 bytes per neighbor and 1 per degree, adjacency grows if needed
+    k->adjacency_capacity = 2 * (2 * (size_t)m) + (size_t)n + 1;
+#else
+    k->adjacency_capacity = 2 * (size_t)m + 1; // + 1 to avoid malloc(0)
+#endif
+    k->offsets = malloc(((size_t)n + 1) * sizeof(size_t));
+    k->adjacency = malloc(k->adjacency_capacity * sizeof(KernelEntry));
+    k->ids = malloc(((size_t)n + 1) * sizeof(uint32_t));
+    k->dominated_by_fixed = malloc(((size_t)n + 1) * sizeof(uint32_t));
+    k->fixed_ids = malloc((fixed_count + 1) * sizeof(uint32_t));
+    if(!k->offsets || !k->adjacency || !k->ids || !k->dominated_by_fixed || !k->fixed_ids) {
+        kernel_free(k);
+        return NULL;
+    }
+    k->offsets[0] = 0;
+    return k;
+}
+
+
+
+// make sure adjacency has space for entries entries, returns false if the allocation failed
+bool kernel_reserve_adjacency(Kernel* k, size_t entries)
+{
+    assert(k != NULL);
+    if(entries > k->adjacency_capacity) {
+        KernelEntry* adjacency = realloc(k->adjacency, entries * sizeof(KernelEntry));
+        if(!adjacency) {
+            return false;
+        }
+        k->adjacency = adjacency;
+        k->adjacency_capacity = entries;
+    }
+    return true;
+}
+
+
+
+// write value as a varint to *position and move *position behind it, see Kernel
+static void _encode_varint(uint8_t** position, uint64_t value)
+{
+    while(value >= 0x80) {
+        *((*position)++) = (uint8_t)((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    *((*position)++) = (uint8_t)value;
+}
+
+
+
+// the zigzag encoding of the difference to - from, see Kernel
+static inline uint64_t _zigzag(uint32_t from, uint32_t to)
+{
+    return to >= from ? 2 * (uint64_t)(to - from) : 2 * (uint64_t)(from - to) - 1;
+}
+
+
+
+// the inverse of _zigzag: to, given from and the zigzag encoded difference
+static inline uint32_t _unzigzag(uint32_t from, uint64_t zigzag)
+{
+    return (uint32_t)((uint64_t)from + ((zigzag >> 1) ^ (0 - (zigzag & 1))));
+}
+
+
+
+#ifdef KERNEL_COMPRESSED
+static int _compare_uint32(const void* a, const void* b)
+{
+    const uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+
+
+// like kernel_decode_varint, but returns false instead of reading beyond end or more than MAX_VARINT_LENGTH bytes
+static bool _decode_varint_checked(const KernelEntry** position, const KernelEntry* end, uint64_t* value)
+{
+    *value = 0;
+    for(unsigned i = 0; i < MAX_VARINT_LENGTH && *position < end; i++) {
+        const KernelEntry byte = *((*position)++);
+        *value |= (uint64_t)(byte & 0x7f) << (7 * i);
+        if(!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+
+
+// set the neighbors of v, which must be 0 for the first call and the previous v + 1 for every further one. This
+// sets offsets[v + 1]. The array neighbors may be reordered. After the last vertex, the unused capacity of
+// adjacency is released. Returns false if growing adjacency failed.
+bool kernel_add_neighbors(Kernel* k, uint32_t v, uint32_t* neighbors, uint32_t degree)
+{
+    assert(k != NULL && v < k->n && (neighbors != NULL || degree == 0));
+    const size_t offset = k->offsets[v];
+#ifdef KERNEL_COMPRESSED
+    const size_t needed = offset + MAX_VARINT_LENGTH * ((size_t)degree + 1);
+    const size_t grown = k->adjacency_capacity / 2 * 3;
+    if(needed > k->adjacency_capacity && !kernel_reserve_adjacency(k, needed > grown ? needed : grown)) {
+        return false;
+    }
+    qsort(neighbors, degree, sizeof(uint32_t), _compare_uint32);
+    KernelEntry* position = &(k->adjacency[offset]);
+    _encode_varint(&position, degree);
+    if(degree > 0) {
+        _encode_varint(&position, _zigzag(v, neighbors[0]));
+    }
+    for(uint32_t i = 1; i < degree; i++) {
+        _encode_varint(&position, neighbors[i] - neighbors[i - 1]);
+    }
+    k->offsets[v + 1] = (size_t)(position - k->adjacency);
+#else
+    if(!kernel_reserve_adjacency(k, offset + degree)) {
+        return false;
+    }
+    memcpy(&(k->adjacency[offset]), neighbors, (size_t)degree * sizeof(uint32_t));
+    k->offsets[v + 1] = offset + degree;
+#endif
+    if(v + 1 == k->n && k->offsets[k->n] + 1 < k->adjacency_capacity) {
+        // shrinking keeps the data, so a failure only keeps the larger array
+        KernelEntry* adjacency = realloc(k->adjacency, (k->offsets[k->n] + 1) * sizeof(KernelEntry));
+        if(adjacency) {
+            k->adjacency = adjacency;
+            k->adjacency_capacity = k->offsets[k->n] + 1;
+        }
+    }
+    return true;
+}
+
+
+
+// check that the neighbor lists of k are within adjacency, have m edges in total and only contain vertices
+// of k, e.g. after reading them from a file
+bool kernel_adjacency_is_valid(const Kernel* k)
+{
+    assert(k != NULL);
+    if(k->offsets[0] != 0 || k->offsets[k->n] > k->adjacency_capacity) {
+        return false;
+    }
+    uint64_t neighbor_count = 0;
+    for(uint32_t v = 0; v < k->n; v++) {
+        if(k->offsets[v] > k->offsets[v + 1]) {
+            return false;
+        }
+#ifdef KERNEL_COMPRESSED
+        const KernelEntry* position = &(k->adjacency[k->offsets[v]]);
+        const KernelEntry* end = &(k->adjacency[k->offsets[v + 1]]);
+        uint64_t degree, value;
+        if(!_decode_varint_checked(&position, end, &degree) || degree > UINT32_MAX) {
+            return false;
+        }
+        uint64_t neighbor = v;
+        for(uint64_t i = 0; i < degree; i++) { // every varint has at least 1 byte, so this ends at end
+            if(!_decode_varint_checked(&position, end, &value)) {
+                return false;
+            }
+            if(i > 0) {
+                neighbor += value;
+            }
+            else if(value & 1) { // the first neighbor is v - (value >> 1) - 1, which must not be negative
+                if((value >> 1) >= v) {
+                    return false;
+                }
+                neighbor = v - (value >> 1) - 1;
+            }
+            else {
+                neighbor = v + (value >> 1);
+            }
+            if(neighbor >= k->n) {
+                return false;
+            }
+        }
+        if(position != end) {
+            return false;
+        }
+        neighbor_count += degree;
+#else
+        for(size_t i_v = k->offsets[v]; i_v < k->offsets[v + 1]; i_v++) {
+            if(k->adjacency[i_v] >= k->n) {
+                return false;
+            }
+        }
+        neighbor_count += k->offsets[v + 1] - k->offsets[v];
+#endif
+    }
+    return neighbor_count == 2 * k->m;
+}
+
+
+
+// build the kernel from the (reduced) graph g. g is not changed.
+// caller is responsible for freeing using kernel_free(...)
+Kernel* kernel_from_graph(const Graph* g)
+{
+    assert(g != NULL);
+    Kernel* k = kernel_new(g->n, g->m, g->fixed.size);
+    if(!k) {
+        return NULL;
+    }
+    k->id_max = g->id_max;
+
+    // the ids are not contiguous anymore after the reduction, so a temporary map from id to index is needed
+    uint32_t* index_by_id = malloc(((size_t)g->id_max + 1) * sizeof(uint32_t));
+    uint32_t max_degree = 0;
+    for(uint32_t i = 0; i < g->n; i++) {
+        max_degree = g->vertices[i]->degree > max_degree ? g->vertices[i]->degree : max_degree;
+    }
+    uint32_t* neighbors = malloc(((size_t)max_degree + 1) * sizeof(uint32_t)); // the neighbors of one vertex
+    if(!index_by_id || !neighbors) {
+        perror("kernel_from_graph: allocating array failed");
+        exit(EXIT_FAILURE);
+    }
+
+    for(uint32_t i = 0; i < g->n; i++) {
+        const Vertex* v = g->vertices[i];
+        index_by_id[v->id] = i;
+        k->ids[i] = v->id;
+        k->dominated_by_fixed[i] = v->dominated_by_number;
+    }
+    for(uint32_t i = 0; i < g->n; i++) {
+        const Vertex* v = g->vertices[i];
+        for(uint32_t i_v = 0; i_v < v->degree; i_v++) {
+            neighbors[i_v] = index_by_id[v->neighbors[i_v]->id];
+        }
+        if(!kernel_add_neighbors(k, i, neighbors, v->degree)) {
+            free(index_by_id);
+            free(neighbors);
+            kernel_free(k);
+            return NULL;
+        }
+    }
+
+    for(size_t fixed_idx = 0; fixed_idx < g->fixed.size; fixed_idx++) {
+        k->fixed_ids[fixed_idx] = g->fixed.vertices[fixed_idx]->id;
+    }
+    free(index_by_id);
+    free(neighbors);
+    return k;
+}
+
+
+
+// free everything kernel_parse has allocated so far when it cannot continue, and set errno to error
+// returns NULL
+static Kernel* _abort_kernel_parse(Kernel* k, uint8_t* edges, uint32_t* degrees, bool* is_dominated,
+                                   uint32_t* block, bool** streaming_ds_by_id, int error)
+{
+    if(k != NULL) {
+        kernel_free(k);
+    }
+    free(edges);
+    free(degrees);
+    free(is_dominated);
+    free(block);
+    free(*streaming_ds_by_id);
+    *streaming_ds_by_id = NULL;
+    errno = error;
+    return NULL;
+}
+
+
+
+// read the edge at *position of the edge stream of kernel_parse and move *position behind it. *a_id is the first
+// endpoint of the previous edge before, or 0 for the first edge.
+static inline void _next_edge(const uint8_t** position, uint32_t* a_id, uint32_t* b_id)
+{
+    *a_id = _unzigzag(*a_id, kernel_decode_varint(position));
+    *b_id = _unzigzag(*a_id, kernel_decode_varint(position));
+}
+
+
+
+// complete the streaming ds of kernel_parse like _streaming_ds_fixup of graph.c: dominate each vertex that is
+// not dominated yet by its neighbor of highest degree, or by itself if k is NULL (the kernel is not complete)
+// or a stop is requested in the meantime. The vertex with the id v + 1 is v in k.
+static void _kernel_streaming_ds_fixup(const Kernel* k, uint32_t n, bool* in_ds, bool* is_dominated,
+                                       const StopCondition* stop)
+{
+    bool by_neighbors = k != NULL;
+    for(uint32_t id = 1; id <= n; id++) {
+        if(by_neighbors && id % KERNEL_FIXUP_STOP_CHECK_INTERVAL == 0 && stop_requested(stop)) {
+            by_neighbors = false;
+        }
+        if(is_dominated[id]) {
+            continue;
+        }
+        uint32_t best = id - 1, u;
+        if(by_neighbors) {
+            for(KernelNeighbors it = kernel_neighbors(k, id - 1); kernel_next_neighbor(&it, &u);) {
+                if(kernel_degree(k, u) > kernel_degree(k, best)) {
+                    best = u;
+                }
+            }
+        }
+        assert(!in_ds[best + 1]);
+        in_ds[best + 1] = true;
+        is_dominated[best + 1] = true;
+        if(by_neighbors) {
+            for(KernelNeighbors it = kernel_neighbors(k, best); kernel_next_neighbor(&it, &u);) {
+                is_dominated[u + 1] = true;
+            }
+        }
+    }
+}
+
+
+
+// parse a graph in the PACE format directly into a kernel, without building a Graph and without reducing it.
+// This is for graphs that are too large for graph_parse, which needs about 32 bytes per edge: the edges are
+// kept delta and varint encoded like the neighbor lists of KERNEL_COMPRESSED, mostly in 2 to 6 bytes per edge,
+// until the kernel is built, which then takes 8 bytes per edge (or mostly 2 to 6 with KERNEL_COMPRESSED).
+// The vertex with the id v + 1 has the index v. *id_max is set to the largest vertex id, and *streaming_ds_by_id
+// to the streaming ds of the graph (see Graph), which the caller has to free.
+// If a stop is requested while the edges are parsed or the kernel is built, NULL is returned, but the streaming
+// ds is still valid. Returns NULL with an error message and *streaming_ds_by_id == NULL if the input is not valid
+// (then errno == EINVAL) or an allocation failed (then errno == ENOMEM).
+// caller is responsible for freeing using kernel_free(...)
+Kernel* kernel_parse(FILE* file, const StopCondition* stop, bool** streaming_ds_by_id, uint32_t* id_max)
+{
+    assert(file != NULL && stop != NULL && streaming_ds_by_id != NULL && id_max != NULL);
+    *streaming_ds_by_id = NULL;
+    *id_max = 0;
+    uint32_t n;
+    uint64_t m;
+    if(!graph_parse_problem_line(file, &n, &m)) {
+        return NULL;
+    }
+    *id_max = n;
+
+    // the edge stream: for each edge {a, b}, the differences of a to the a of the previous edge and of b to a,
+    // see _next_edge. degrees[v + 1] is the degree of the vertex v, i.e. indexed by id, until the neighbor lists
+    // are gathered.
+    size_t edges_capacity = 4 * (size_t)m + MAX_EDGE_LENGTH; // a guess, the stream grows if needed
+    size_t edges_size = 0;
+    uint8_t* edges = malloc(edges_capacity);
+    uint32_t* degrees = calloc((size_t)n + 1, sizeof(uint32_t));
+    bool* is_dominated = calloc((size_t)n + 1, sizeof(bool)); // temporary array for the streaming ds
+    *streaming_ds_by_id = calloc((size_t)n + 1, sizeof(bool));
+    Kernel* k = kernel_new(n, m, 0);
+    if(!edges || !degrees || !is_dominated || !*streaming_ds_by_id || !k) {
+        perror("kernel_parse: allocating array failed");
+        return _abort_kernel_parse(k, edges, degrees, is_dominated, NULL, streaming_ds_by_id, ENOMEM);
+    }
+    bool* in_ds = *streaming_ds_by_id;
+    k->id_max = n;
+
+    // read the edges and build the streaming ds on the way, like graph_parse
+    bool is_stopped = false;
+    uint64_t edges_read = 0;
+    uint32_t previous_id = 0;
+    for(uint64_t i = 0; i < m; i++) {
+        if(i % KERNEL_PARSE_STOP_CHECK_INTERVAL == 0 && stop_requested(stop)) {
+            is_stopped = true;
+            break;
+        }
+        uint32_t u_id, v_id;
+        if(fscanf(file, "\t%" SCNu32 " %" SCNu32 "\n", &u_id, &v_id) != 2 || u_id == 0 || u_id > n || v_id == 0 ||
+           v_id > n || u_id == v_id) {
+            fprintf(stderr, "kernel_parse: edge %" PRIu64 " of %" PRIu64 " is missing or not valid\n", i + 1, m);
+            return _abort_kernel_parse(k, edges, degrees, is_dominated, NULL, streaming_ds_by_id, EINVAL);
+        }
+        if(edges_size + MAX_EDGE_LENGTH > edges_capacity) {
+            edges_capacity += edges_capacity / 2;
+            uint8_t* new_edges = realloc(edges, edges_capacity);
+            if(!new_edges) {
+                perror("kernel_parse: allocating array failed");
+                return _abort_kernel_parse(k, edges, degrees, is_dominated, NULL, streaming_ds_by_id, ENOMEM);
+            }
+            edges = new_edges;
+        }
+        uint8_t* position = &(edges[edges_size]);
+        _encode_varint(&position, _zigzag(previous_id, u_id));
+        _encode_varint(&position, _zigzag(u_id, v_id));
+        edges_size = (size_t)(position - edges);
+        previous_id = u_id;
+        degrees[u_id]++;
+        degrees[v_id]++;
+        if(!is_dominated[u_id] && !is_dominated[v_id]) {
+            in_ds[degrees[u_id] >= degrees[v_id] ? u_id : v_id] = true;
+            is_dominated[u_id] = is_dominated[v_id] = true;
+        }
+        else {
+            is_dominated[u_id] |= in_ds[v_id];
+            is_dominated[v_id] |= in_ds[u_id];
+        }
+        edges_read++;
+    }
+    // a vertex may be dominated through an edge that was read before its neighbor joined the ds
+    const uint8_t* position = edges;
+    uint32_t a_id = 0, b_id;
+    for(uint64_t i = 0; i < edges_read; i++) {
+        _next_edge(&position, &a_id, &b_id);
+        is_dominated[a_id] |= in_ds[b_id];
+        is_dominated[b_id] |= in_ds[a_id];
+    }
+
+    // gather the neighbor lists of the vertices first, ..., last - 1 in block, in one pass over the edges per
+    // block, so that only a part of the lists has to be held besides the edges and the kernel
+    uint32_t max_degree = 0;
+    for(uint32_t v = 0; v < n; v++) {
+        max_degree = degrees[v + 1] > max_degree ? degrees[v + 1] : max_degree;
+    }
+    size_t block_capacity = 2 * (size_t)m / KERNEL_PARSE_PASSES;
+    block_capacity = block_capacity > KERNEL_PARSE_MIN_BLOCK ? block_capacity : KERNEL_PARSE_MIN_BLOCK;
+    block_capacity = block_capacity < 2 * (size_t)m ? block_capacity : 2 * (size_t)m;
+    block_capacity = block_capacity > max_degree ? block_capacity : max_degree;
+    uint32_t* block = malloc((block_capacity + 1) * sizeof(uint32_t));
+    if(!block) {
+        perror("kernel_parse: allocating array failed");
+        return _abort_kernel_parse(k, edges, degrees, is_dominated, NULL, streaming_ds_by_id, ENOMEM);
+    }
+    uint64_t edges_scanned = 0;
+    for(uint32_t first = 0; first < n && !is_stopped;) {
+        // turn degrees[v + 1] into the start of the list of v in block. While the edges are scanned, it is the
+        // position of the next neighbor, and afterwards the end of the list.
+        uint32_t last = first;
+        size_t block_size = 0;
+        while(last < n && block_size + degrees[last + 1] <= block_capacity) {
+            const uint32_t degree = degrees[last + 1];
+            degrees[last + 1] = (uint32_t)block_size;
+            block_size += degree;
+            last++;
+        }
+        position = edges;
+        a_id = 0;
+        for(uint64_t i = 0; i < m; i++) {
+            if(edges_scanned++ % KERNEL_PARSE_STOP_CHECK_INTERVAL == 0 && stop_requested(stop)) {
+                is_stopped = true;
+                break;
+            }
+            _next_edge(&position, &a_id, &b_id);
+            const uint32_t a = a_id - 1, b = b_id - 1;
+            if(a >= first && a < last) {
+                block[degrees[a + 1]++] = b;
+            }
+            if(b >= first && b < last) {
+                block[degrees[b + 1]++] = a;
+            }
+        }
+        for(uint32_t v = first; v < last && !is_stopped; v++) {
+            const uint32_t start = v == first ? 0 : degrees[v];
+            k->ids[v] = v + 1;
+            k->dominated_by_fixed[v] = 0;
+            if(!kernel_add_neighbors(k, v, &(block[start]), degrees[v + 1] - start)) {
+                perror("kernel_parse: allocating the neighbor lists failed");
+                return _abort_kernel_parse(k, edges, degrees, is_dominated, block, streaming_ds_by_id, ENOMEM);
+            }
+        }
+        first = last;
+    }
+    free(edges);
+    free(degrees);
+    free(block);
+    if(is_stopped) {
+        kernel_free(k);
+        k = NULL;
+    }
+    _kernel_streaming_ds_fixup(k, n, in_ds, is_dominated, stop);
+    free(is_dominated);
+    return k;
+}
+
+
+
+// map a vertex set of the input graph, given by in_set_by_id[id] for every vertex id, to the kernel:
+// in_set[v] = in_set_by_id[k->ids[v]] for all v in [0, k->n). Vertices that are not in the kernel are dropped.
+void kernel_project_set(const Kernel* k, const bool* in_set_by_id, bool* in_set)
+{
+    assert(k != NULL && in_set_by_id != NULL && in_set != NULL);
+    for(uint32_t v = 0; v < k->n; v++) {
+        in_set[v] = in_set_by_id[k->ids[v]];
+    }
+}
+
+
+
+// write k as a graph in the PACE input format, with the kernel vertex v named v + 1.
+// Any dominating set of this graph together with the fixed vertices is a dominating set of the input graph.
+// Comment lines before the problem line give the original id of every vertex ("c id <vertex> <original id>"), the kernel vertices
+// that are already dominated by fixed vertices and therefore only optionally need to be dominated
+// ("c dominated <vertex>"), and the fixed vertices ("c fixed <original id>").
+// returns false if writing failed
+bool kernel_export_pace(const Kernel* k, FILE* file)
+{
+    assert(k != NULL && file != NULL);
+    for(size_t fixed_idx = 0; fixed_idx < k->fixed_count; fixed_idx++) {
+        fprintf(file, "c fixed %" PRIu32 "\n", k->fixed_ids[fixed_idx]);
+    }
+    for(uint32_t v = 0; v < k->n; v++) {
+        fprintf(file, "c id %" PRIu32 " %" PRIu32 "\n", v + 1, k->ids[v]);
+        if(k->dominated_by_fixed[v] > 0) {
+            fprintf(file, "c dominated %" PRIu32 "\n", v + 1);
+        }
+    }
+    fprintf(file, "p ds %" PRIu32 " %" PRIu64 "\n", k->n, k->m); // after the comments, as graph_parse expects
+    for(uint32_t v = 0; v < k->n; v++) {
+        uint32_t u;
+        for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+            if(u > v) { // print every edge only once
+                fprintf(file, "%" PRIu32 " %" PRIu32 "\n", v + 1, u + 1);
+            }
+        }
+    }
+    return fflush(file) == 0 && !ferror(file);
+}
+
+
+
+// free the kernel and all of its arrays
+// k must not be NULL
+void kernel_free(Kernel* k)
+{
+    assert(k != NULL);
+    free(k->offsets);
+    free(k->adjacency);
+    free(k->ids);
+    free(k->dominated_by_fixed);
+    free(k->fixed_ids);
+    free(k);
+}
@@ -0,0 +1,194 @@
+#ifndef _KERNEL_H
+#define _KERNEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "graph.h"
+
+
+
+// Compact, immutable representation of the graph that remains after the reduction (the kernel).
+// Vertices are identified by their index in [0, n). The neighbors of vertex v are listed with kernel_neighbors
+// and kernel_next_neighbor. They are stored in adjacency[offsets[v]], ..., adjacency[offsets[v + 1] - 1]
+// (compressed sparse row format), one uint32_t index per neighbor.
+// For graphs that do not fit into memory otherwise, the build with KERNEL_COMPRESSED (make compressed) stores
+// them in bytes instead: the degree of v, the first neighbor minus v (zigzag encoded, i.e. 2 d for d >= 0 and
+// -2 d - 1 for d < 0), and the difference of each following neighbor to the previous one, in increasing order.
+// Each number is a varint, 7 bits per byte starting with the lowest, and the highest bit is set in all bytes
+// but the last. The differences mostly take 1 to 3 bytes instead of 4, and they are decoded on the fly.
+// Nothing in a Kernel is changed after it has been built, so it can be shared by several threads.
+#ifdef KERNEL_COMPRESSED
+typedef uint8_t KernelEntry;
+#else
+typedef uint32_t KernelEntry;
+#endif
+
+typedef struct Kernel {
+    size_t* offsets;              // n + 1 entries
+    KernelEntry* adjacency;       // offsets[n] entries, the neighbors of all vertices (2 * m if not compressed)
+    size_t adjacency_capacity;    // the number of entries allocated for adjacency
+    uint32_t* ids;                // n entries, the original ids of the vertices
+    uint32_t* dominated_by_fixed; // n entries, the number of fixed vertices each vertex is dominated by
+    uint32_t* fixed_ids;          // ids of the vertices that were fixed during the reduction
+    size_t fixed_count;           // number of elements in fixed_ids
+    uint32_t n;                   // number of vertices
+    uint64_t m;                   // number of edges
+    uint32_t id_max;              // the largest vertex id of the input graph
+} Kernel;
+
+
+// the state of listing the neighbors of a vertex, see kernel_neighbors
+typedef struct KernelNeighbors {
+    const KernelEntry* next;
+#ifdef KERNEL_COMPRESSED
+    uint32_t remaining; // the number of neighbors that have not been returned yet
+    uint32_t current;   // the next neighbor, if remaining > 0
+#else
+    const KernelEntry* end;
+#endif
+} KernelNeighbors;
+
+
+
+// read the varint at *position and move *position behind it, see Kernel
+static inline uint64_t kernel_decode_varint(const uint8_t** position)
+{
+    uint64_t value = 0;
+    unsigned shift = 0;
+    uint8_t byte;
+    do {
+        byte = *((*position)++);
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while(byte & 0x80);
+    return value;
+}
+
+
+
+static inline uint32_t kernel_degree(const Kernel* k, uint32_t v)
+{
+#ifdef KERNEL_COMPRESSED
+    const KernelEntry* position = &(k->adjacency[k->offsets[v]]);
+    return (uint32_t)kernel_decode_varint(&position);
+#else
+    return (uint32_t)(k->offsets[v + 1] - k->offsets[v]);
+#endif
+}
+
+
+
+// start listing the neighbors of v: for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);)
+static inline KernelNeighbors kernel_neighbors(const Kernel* k, uint32_t v)
+{
+#ifdef KERNEL_COMPRESSED
+    KernelNeighbors it = {.next = &(k->adjacency[k->offsets[v]]), .remaining = 0, .current = 0};
+    it.remaining = (uint32_t)kernel_decode_varint(&(it.next));
+    if(it.remaining > 0) {
+        const uint64_t zigzag = kernel_decode_varint(&(it.next));
+        it.current = (uint32_t)((uint64_t)v + ((zigzag >> 1) ^ (0 - (zigzag & 1))));
+    }
+    return it;
+#else
+    const KernelNeighbors it = {.next = &(k->adjacency[k->offsets[v]]), .end = &(k->adjacency[k->offsets[v + 1]])};
+    return it;
+#endif
+}
+
+
+
+// set *u to the next neighbor, returns false if there is none
+static inline bool kernel_next_neighbor(KernelNeighbors* it, uint32_t* u)
+{
+#ifdef KERNEL_COMPRESSED
+    if(it->remaining == 0) {
+        return false;
+    }
+    *u = it->current;
+    if(--(it->remaining) > 0) {
+        it->current += (uint32_t)kernel_decode_varint(&(it->next));
+    }
+    return true;
+#else
+    if(it->next == it->end) {
+        return false;
+    }
+    *u = *((it->next)++);
+    return true;
+#endif
+}
+
+
+
+// allocate a kernel with n vertices, m edges and fixed_count fixed vertices. Only the sizes are set, the
+// contents of the arrays are uninitialized, and the neighbors are added with kernel_add_neighbors.
+// Returns NULL if not successful.
+// caller is responsible for freeing using kernel_free(...)
+Kernel* kernel_new(uint32_t n, uint64_t m, size_t fixed_count);
+
+
+
+// set the neighbors of v, which must be 0 for the first call and the previous v + 1 for every further one. This
+// sets offsets[v + 1]. The array neighbors may be reordered. After the last vertex, the unused capacity of
+// adjacency is released. Returns false if growing adjacency failed.
+bool kernel_add_neighbors(Kernel* k, uint32_t v, uint32_t* neighbors, uint32_t degree);
+
+
+
+// make sure adjacency has space for entries entries, returns false if the allocation failed
+bool kernel_reserve_adjacency(Kernel* k, size_t entries);
+
+
+
+// check that the neighbor lists of k are within adjacency, have m edges in total and only contain vertices
+// of k, e.g. after reading them from a file
+bool kernel_adjacency_is_valid(const Kernel* k);
+
+
+
+// build the kernel from the (reduced) graph g. g is not changed.
+// caller is responsible for freeing using kernel_free(...)
+Kernel* kernel_from_graph(const Graph* g);
+
+
+
+// parse a graph in the PACE format directly into a kernel, without building a Graph and without reducing it.
+// This is for graphs that are too large for graph_parse, which needs about 32 bytes per edge: the edges are
+// kept delta and varint encoded like the neighbor lists of KERNEL_COMPRESSED, mostly in 2 to 6 bytes per edge,
+// until the kernel is built, which then takes 8 bytes per edge (or mostly 2 to 6 with KERNEL_COMPRESSED).
+// The vertex with the id v + 1 has the index v. *id_max is set to the largest vertex id, and *streaming_ds_by_id
+// to the streaming ds of the graph (see Graph), which the caller has to free.
+// If a stop is requested while the edges are parsed or the kernel is built, NULL is returned, but the streaming
+// ds is still valid. Returns NULL with an error message and *streaming_ds_by_id == NULL if the input is not valid
+// (then errno == EINVAL) or an allocation failed (then errno == ENOMEM).
+// caller is responsible for freeing using kernel_free(...)
+Kernel* kernel_parse(FILE* file, const StopCondition* stop, bool** streaming_ds_by_id, uint32_t* id_max);
+
+
+
+// map a vertex set of the input graph, given by in_set_by_id[id] for every vertex id, to the kernel:
+// in_set[v] = in_set_by_id[k->ids[v]] for all v in [0, k->n). Vertices that are not in the kernel are dropped.
+void kernel_project_set(const Kernel* k, const bool* in_set_by_id, bool* in_set);
+
+
+
+// write k as a graph in the PACE input format, with the kernel vertex v named v + 1.
+// Any dominating set of this graph together with the fixed vertices is a dominating set of the input graph.
+// Comment lines before the problem line give the original id of every vertex ("c id <vertex> <original id>"), the kernel vertices
+// that are already dominated by fixed vertices and therefore only optionally need to be dominated
+// ("c dominated <vertex>"), and the fixed vertices ("c fixed <original id>").
+// returns false if writing failed
+bool kernel_export_pace(const Kernel* k, FILE* file);
+
+
+
+// free the kernel and all of its arrays
+// k must not be NULL
+void kernel_free(Kernel* k);
+
+
+
+#endif
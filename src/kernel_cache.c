@@ -0,0 +1,257 @@
+#include "kernel_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "debug_log.h"
+
+
+
+#define KERNEL_CACHE_MAGIC   0x4c4e524b5344ULL // "DSKRNL"
+#define KERNEL_CACHE_VERSION 3
+#define INPUT_CHUNK_SIZE     (1 << 20) // the input buffer grows by at least x bytes at a time
+#ifdef KERNEL_COMPRESSED // the storage of the neighbor lists, see Kernel. The files of both have different names.
+#define KERNEL_CACHE_LAYOUT 1
+#define KERNEL_CACHE_SUFFIX ".varint.bin"
+#else
+#define KERNEL_CACHE_LAYOUT 0
+#define KERNEL_CACHE_SUFFIX ".bin"
+#endif
+
+
+
+typedef struct CacheHeader {
+    uint64_t magic;
+    uint64_t hash;
+    uint64_t check;      // see InputBuffer
+    uint64_t input_size; // in bytes
+    uint64_t fixed_count;
+    uint64_t m;
+    uint32_t version;
+    uint32_t n;
+    uint32_t id_max;
+    uint32_t layout; // KERNEL_CACHE_LAYOUT, also so that the header has no padding
+} CacheHeader;
+
+
+
+// a fast non-cryptographic hash that reads 8 bytes at a time. A second hash with other constants, which
+// is computed in the same pass, is stored in *check.
+static uint64_t _hash_bytes(const char* data, size_t size, uint64_t* check)
+{
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (uint64_t)size;
+    uint64_t c = 0xcbf29ce484222325ULL; // the offset basis of FNV-1a
+    size_t i = 0;
+    for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, &(data[i]), sizeof(uint64_t));
+        h = (h ^ word) * 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 29;
+        c = (c + word) * 0x100000001b3ULL; // the prime of FNV-1a
+        c ^= c >> 32;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, &(data[i]), size - i);
+    h = (h ^ tail) * 0xbf58476d1ce4e5b9ULL;
+    c = (c + tail) * 0x100000001b3ULL;
+    // final mixing, as in splitmix64 and in MurmurHash3
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    c = (c ^ (c >> 33)) * 0xff51afd7ed558ccdULL;
+    c = (c ^ (c >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+    *check = c ^ (c >> 33);
+    return h ^ (h >> 31);
+}
+
+
+
+// the result of kernel_cache_read_input on failure: the message is printed and errno keeps its value
+static InputBuffer _read_failed(InputBuffer* buffer, const char* message)
+{
+    const int error = errno;
+    perror(message);
+    free(buffer->data);
+    errno = error;
+    return (InputBuffer){.data = NULL, .size = 0, .hash = 0, .check = 0};
+}
+
+
+
+// read file until its end into a buffer and hash it.
+// returns a buffer with data == NULL on failure, then errno is ENOMEM if the buffer could not be allocated,
+// or the error of reading the file
+// free the buffer with free(buffer.data)
+InputBuffer kernel_cache_read_input(FILE* file)
+{
+    InputBuffer buffer = {.data = NULL, .size = 0, .hash = 0, .check = 0};
+    size_t capacity = 0;
+    while(true) {
+        if(capacity - buffer.size < INPUT_CHUNK_SIZE) {
+            capacity = 2 * capacity + INPUT_CHUNK_SIZE;
+            char* new_data = realloc(buffer.data, capacity);
+            if(!new_data) {
+                errno = ENOMEM;
+                return _read_failed(&buffer, "kernel_cache_read_input: allocating input buffer failed");
+            }
+            buffer.data = new_data;
+        }
+        size_t read = fread(&(buffer.data[buffer.size]), 1, capacity - buffer.size, file);
+        buffer.size += read;
+        if(read == 0) {
+            break;
+        }
+    }
+    if(ferror(file)) {
+        if(errno == 0 || errno == ENOMEM) { // a read error must not be mistaken for a failed allocation
+            errno = EIO;
+        }
+        return _read_failed(&buffer, "kernel_cache_read_input: reading input failed");
+    }
+    buffer.hash = _hash_bytes(buffer.data, buffer.size, &buffer.check);
+    return buffer;
+}
+
+
+
+// returns the path of the cache file, or of the temporary file if temporary, or NULL on failure
+// caller is responsible for freeing the returned string
+static char* _cache_path(const char* directory, uint64_t hash, bool temporary)
+{
+    assert(directory != NULL);
+    const size_t length = strlen(directory) + 64;
+    char* path = malloc(length);
+    if(!path) {
+        return NULL;
+    }
+    if(temporary) {
+        snprintf(path, length, "%s/kernel-%016" PRIx64 KERNEL_CACHE_SUFFIX ".tmp%ld", directory, hash, (long)getpid());
+    }
+    else {
+        snprintf(path, length, "%s/kernel-%016" PRIx64 KERNEL_CACHE_SUFFIX, directory, hash);
+    }
+    return path;
+}
+
+
+
+// check that the arrays of k describe a valid kernel, so that a corrupted cache file cannot cause
+// out of bounds accesses later on
+static bool _is_consistent(const Kernel* k)
+{
+    if(!kernel_adjacency_is_valid(k)) {
+        return false;
+    }
+    for(uint32_t v = 0; v < k->n; v++) {
+        if(k->ids[v] == 0 || k->ids[v] > k->id_max) {
+            return false;
+        }
+    }
+    for(size_t fixed_idx = 0; fixed_idx < k->fixed_count; fixed_idx++) {
+        if(k->fixed_ids[fixed_idx] == 0 || k->fixed_ids[fixed_idx] > k->id_max) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+// load the kernel of input from the cache directory.
+// returns NULL if it is not in the cache or the cache file is not valid or belongs to another input with the
+// same hash (then the input size or the second hash differs)
+// caller is responsible for freeing using kernel_free(...)
+Kernel* kernel_cache_load(const char* directory, const InputBuffer* input)
+{
+    const uint64_t hash = input->hash;
+    char* path = _cache_path(directory, hash, false);
+    if(!path) {
+        return NULL;
+    }
+    FILE* file = fopen(path, "rb");
+    free(path);
+    if(!file) {
+        return NULL;
+    }
+    CacheHeader header;
+    Kernel* k = NULL;
+    if(fread(&header, sizeof(header), 1, file) == 1 && header.magic == KERNEL_CACHE_MAGIC &&
+       header.version == KERNEL_CACHE_VERSION && header.layout == KERNEL_CACHE_LAYOUT && header.hash == hash) {
+        if(header.check == input->check && header.input_size == input->size) {
+            k = kernel_new(header.n, header.m, (size_t)header.fixed_count);
+        }
+        else {
+            fprintf(stderr, "kernel_cache_load: ignoring the cache file of another input with the same hash\n");
+        }
+    }
+    if(k != NULL) {
+        k->id_max = header.id_max;
+        // the size of the neighbor lists is only known from the offsets, see Kernel
+        const bool complete = fread(k->offsets, sizeof(size_t), (size_t)k->n + 1, file) == (size_t)k->n + 1 &&
+                              kernel_reserve_adjacency(k, k->offsets[k->n]) &&
+                              fread(k->adjacency, sizeof(KernelEntry), k->offsets[k->n], file) == k->offsets[k->n] &&
+                              fread(k->ids, sizeof(uint32_t), k->n, file) == k->n &&
+                              fread(k->dominated_by_fixed, sizeof(uint32_t), k->n, file) == k->n &&
+                              fread(k->fixed_ids, sizeof(uint32_t), k->fixed_count, file) == k->fixed_count;
+        if(!complete || !_is_consistent(k)) {
+            fprintf(stderr, "kernel_cache_load: ignoring invalid cache file for hash %016" PRIx64 "\n", hash);
+            kernel_free(k);
+            k = NULL;
+        }
+    }
+    fclose(file);
+    return k;
+}
+
+
+
+// store the kernel k of input in the cache directory, which is created if necessary.
+// The file is written under a temporary name first, so that concurrent runs never read a partial file.
+// returns false if the kernel could not be stored
+bool kernel_cache_store(const char* directory, const InputBuffer* input, const Kernel* k)
+{
+    const uint64_t hash = input->hash;
+    if(mkdir(directory, 0777) != 0 && errno != EEXIST) {
+        return false;
+    }
+    char* temporary_path = _cache_path(directory, hash, true);
+    char* path = _cache_path(directory, hash, false);
+    if(!temporary_path || !path) {
+        free(temporary_path);
+        free(path);
+        return false;
+    }
+    FILE* file = fopen(temporary_path, "wb");
+    bool success = file != NULL;
+    if(success) {
+        const CacheHeader header = {.magic = KERNEL_CACHE_MAGIC,
+                                    .hash = hash,
+                                    .check = input->check,
+                                    .input_size = input->size,
+                                    .fixed_count = k->fixed_count,
+                                    .version = KERNEL_CACHE_VERSION,
+                                    .n = k->n,
+                                    .m = k->m,
+                                    .id_max = k->id_max,
+                                    .layout = KERNEL_CACHE_LAYOUT};
+        success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(k->offsets, sizeof(size_t), (size_t)k->n + 1, file) == (size_t)k->n + 1 &&
+                  fwrite(k->adjacency, sizeof(KernelEntry), k->offsets[k->n], file) == k->offsets[k->n] &&
+                  fwrite(k->ids, sizeof(uint32_t), k->n, file) == k->n &&
+                  fwrite(k->dominated_by_fixed, sizeof(uint32_t), k->n, file) == k->n &&
+                  fwrite(k->fixed_ids, sizeof(uint32_t), k->fixed_count, file) == k->fixed_count;
+        success = (fclose(file) == 0) && success;
+        success = success && rename(temporary_path, path) == 0;
+        if(!success) {
+            remove(temporary_path);
+        }
+    }
+    debug_log("kernel cache: %s %s\n", success ? "stored" : "failed to store", path);
+    free(temporary_path);
+    free(path);
+    return success;
+}
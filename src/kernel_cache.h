@@ -0,0 +1,54 @@
+#ifndef _KERNEL_CACHE_H
+#define _KERNEL_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "kernel.h"
+
+
+
+// Cache of kernels on disk, so that parsing and reduction can be skipped when the same input graph is
+// solved again. The input is read into memory and hashed, and the kernel of an input with hash h is stored
+// in the file <cache directory>/kernel-<h>.bin in the native byte order. The file also records the size and
+// a second hash of the input, so that an input whose hash collides with that of another one is not given
+// the wrong kernel.
+
+
+
+// the whole input, read into memory
+typedef struct InputBuffer {
+    char* data;
+    size_t size;
+    uint64_t hash;  // names the cache file
+    uint64_t check; // a second, independent hash, which is compared with the one in the cache file
+} InputBuffer;
+
+
+
+// read file until its end into a buffer and hash it.
+// returns a buffer with data == NULL on failure, then errno is ENOMEM if the buffer could not be allocated,
+// or the error of reading the file
+// free the buffer with free(buffer.data)
+InputBuffer kernel_cache_read_input(FILE* file);
+
+
+
+// load the kernel of input from the cache directory.
+// returns NULL if it is not in the cache or the cache file is not valid or belongs to another input with the
+// same hash (then the input size or the second hash differs)
+// caller is responsible for freeing using kernel_free(...)
+Kernel* kernel_cache_load(const char* directory, const InputBuffer* input);
+
+
+
+// store the kernel k of input in the cache directory, which is created if necessary.
+// The file is written under a temporary name first, so that concurrent runs never read a partial file.
+// returns false if the kernel could not be stored
+bool kernel_cache_store(const char* directory, const InputBuffer* input, const Kernel* k);
+
+
+
+#endif
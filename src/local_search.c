@@ -0,0 +1,322 @@
+#include "local_search.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "fast_random.h"
+#include "debug_log.h"
+
+
+
+#define LS_NO_VERTEX UINT32_MAX
+#define LS_TABU_TENURE_MIN 5 // a moved vertex must not be moved back for at least x steps
+#define LS_TABU_TENURE_RANDOM 8 // plus a random number of steps smaller than x
+#define LS_STOP_CHECK_INTERVAL 256 // check for a stop request after every x steps
+
+
+
+struct LocalSearch {
+    const Kernel* k;
+    uint32_t* loss; // for ds vertices, see local_search.h
+    uint32_t* gain; // for all vertices, see local_search.h
+    /*  For each vertex the xor of the indices of all ds vertices in its closed neighborhood. If a vertex
+        is dominated by exactly one ds vertex and no fixed vertex, this is the index of that ds vertex. */
+    uint32_t* dominator_xor;
+    uint64_t* tabu_until; // the step until which a vertex must not be added to or removed from the ds
+    uint32_t* ds_list;     // all ds vertices, to choose a random one
+    uint32_t* ds_list_pos; // the position of each ds vertex in ds_list
+    uint32_t ds_list_size;
+    uint32_t* hits; // scratch counters for the evaluation of candidates, all 0 between evaluations
+    uint32_t* redundant; // ds vertices whose loss has dropped to 0 in the current step, may contain stale entries
+    uint32_t redundant_size;
+    uint64_t step; // counts all steps ever made, so that tabu_until never has to be reset
+};
+
+
+
+// ls_new may return NULL if not successful. The returned value has to be freed using ls_free(...).
+// All memory is allocated here, ls_run does not allocate anything.
+LocalSearch* ls_new(const Kernel* k)
+{
+    assert(k != NULL);
+    LocalSearch* ls = calloc(1, sizeof(LocalSearch));
+    if(!ls) {
+        return NULL;
+    }
+    const size_t n = (size_t)k->n + 1; // + 1 to avoid malloc(0)
+    ls->k = k;
+    ls->loss = malloc(n * sizeof(uint32_t));
+    ls->gain = malloc(n * sizeof(uint32_t));
+    ls->dominator_xor = malloc(n * sizeof(uint32_t));
+    ls->tabu_until = calloc(n, sizeof(uint64_t));
+    ls->ds_list = malloc(n * sizeof(uint32_t));
+    ls->ds_list_pos = malloc(n * sizeof(uint32_t));
+    ls->hits = calloc(n, sizeof(uint32_t));
+    ls->redundant = malloc(n * sizeof(uint32_t));
+    if(!ls->loss || !ls->gain || !ls->dominator_xor || !ls->tabu_until || !ls->ds_list || !ls->ds_list_pos ||
+       !ls->hits || !ls->redundant) {
+        ls_free(ls);
+        return NULL;
+    }
+    return ls;
+}
+
+
+
+void ls_free(LocalSearch* ls)
+{
+    if(ls == NULL) {
+        return;
+    }
+    free(ls->loss);
+    free(ls->gain);
+    free(ls->dominator_xor);
+    free(ls->tabu_until);
+    free(ls->ds_list);
+    free(ls->ds_list_pos);
+    free(ls->hits);
+    free(ls->redundant);
+    free(ls);
+}
+
+
+
+// x is private if exactly one ds vertex and no fixed vertex dominates it, i.e. removing that ds vertex undominates x
+static inline bool _is_private(const IGState* s, uint32_t x)
+{
+    return s->dominated_by_number[x] == 1 && s->k->dominated_by_fixed[x] == 0;
+}
+
+
+
+// compute all scores from scratch for the current solution of s
+static void _ls_init(LocalSearch* ls, const IGState* s)
+{
+    const Kernel* k = ls->k;
+    memset(ls->loss, 0, (size_t)k->n * sizeof(uint32_t));
+    memset(ls->gain, 0, (size_t)k->n * sizeof(uint32_t));
+    memset(ls->dominator_xor, 0, (size_t)k->n * sizeof(uint32_t));
+    ls->ds_list_size = 0;
+    for(uint32_t v = 0; v < k->n; v++) {
+        if(s->is_in_ds[v]) {
+            ls->ds_list_pos[v] = ls->ds_list_size;
+            ls->ds_list[ls->ds_list_size++] = v;
+            ls->dominator_xor[v] ^= v;
+            uint32_t u;
+            for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+                ls->dominator_xor[u] ^= v;
+            }
+        }
+    }
+    for(uint32_t x = 0; x < k->n; x++) {
+        if(_is_private(s, x)) {
+            ls->loss[ls->dominator_xor[x]]++;
+        }
+        else if(s->dominated_by_number[x] == 0) {
+            ls->gain[x]++;
+            uint32_t u;
+            for(KernelNeighbors it = kernel_neighbors(k, x); kernel_next_neighbor(&it, &u);) {
+                ls->gain[u]++;
+            }
+        }
+    }
+}
+
+
+
+// update the scores after v has been added to the ds, for one vertex x in the closed neighborhood of v
+static inline void _ls_dominate(LocalSearch* ls, IGState* s, uint32_t x, uint32_t v)
+{
+    const Kernel* k = ls->k;
+    s->dominated_by_number[x]++;
+    ls->dominator_xor[x] ^= v;
+    if(s->dominated_by_number[x] == 1) { // x was undominated and is now private to v
+        ls->loss[v]++;
+        ls->gain[x]--;
+        uint32_t u;
+        for(KernelNeighbors it = kernel_neighbors(k, x); kernel_next_neighbor(&it, &u);) {
+            ls->gain[u]--;
+        }
+    }
+    else if(s->dominated_by_number[x] == 2 && k->dominated_by_fixed[x] == 0) { // x is no longer private to its other dominator
+        uint32_t d = ls->dominator_xor[x] ^ v;
+        ls->loss[d]--;
+        if(ls->loss[d] == 0) {
+            ls->redundant[ls->redundant_size++] = d;
+        }
+    }
+}
+
+
+
+// update the scores after v has been removed from the ds, for one vertex x in the closed neighborhood of v
+static inline void _ls_undominate(LocalSearch* ls, IGState* s, uint32_t x, uint32_t v)
+{
+    const Kernel* k = ls->k;
+    s->dominated_by_number[x]--;
+    ls->dominator_xor[x] ^= v;
+    if(s->dominated_by_number[x] == 0) { // x was private to v and is now undominated
+        ls->loss[v]--;
+        ls->gain[x]++;
+        uint32_t u;
+        for(KernelNeighbors it = kernel_neighbors(k, x); kernel_next_neighbor(&it, &u);) {
+            ls->gain[u]++;
+        }
+    }
+    else if(_is_private(s, x)) { // x is now private to its remaining dominator
+        ls->loss[ls->dominator_xor[x]]++;
+    }
+}
+
+
+
+static void _ls_add(LocalSearch* ls, IGState* s, uint32_t v)
+{
+    assert(!s->is_in_ds[v]);
+    const Kernel* k = ls->k;
+    s->is_in_ds[v] = true;
+    s->current_ds_size++;
+    ls->ds_list_pos[v] = ls->ds_list_size;
+    ls->ds_list[ls->ds_list_size++] = v;
+    _ls_dominate(ls, s, v, v);
+    uint32_t u;
+    for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+        _ls_dominate(ls, s, u, v);
+    }
+}
+
+
+
+static void _ls_remove(LocalSearch* ls, IGState* s, uint32_t v)
+{
+    assert(s->is_in_ds[v]);
+    const Kernel* k = ls->k;
+    s->is_in_ds[v] = false;
+    s->current_ds_size--;
+    uint32_t last = ls->ds_list[--ls->ds_list_size];
+    ls->ds_list[ls->ds_list_pos[v]] = last;
+    ls->ds_list_pos[last] = ls->ds_list_pos[v];
+    _ls_undominate(ls, s, v, v);
+    uint32_t u;
+    for(KernelNeighbors it = kernel_neighbors(k, v); kernel_next_neighbor(&it, &u);) {
+        _ls_undominate(ls, s, u, v);
+    }
+}
+
+
+
+// returns the number of ds vertices that would become redundant if w was added to the ds
+static uint32_t _ls_count_redundant_after_adding(LocalSearch* ls, const IGState* s, uint32_t w)
+{
+    const Kernel* k = ls->k;
+    uint32_t count_redundant = 0;
+    // count for every ds vertex how many of its private vertices w would dominate
+    if(_is_private(s, w) && ++(ls->hits[ls->dominator_xor[w]]) == ls->loss[ls->dominator_xor[w]]) {
+        count_redundant++;
+    }
+    uint32_t x;
+    for(KernelNeighbors it = kernel_neighbors(k, w); kernel_next_neighbor(&it, &x);) {
+        if(_is_private(s, x) && ++(ls->hits[ls->dominator_xor[x]]) == ls->loss[ls->dominator_xor[x]]) {
+            count_redundant++;
+        }
+    }
+    // reset the counters. dominator_xor is only a vertex index for private vertices.
+    if(_is_private(s, w)) {
+        ls->hits[ls->dominator_xor[w]] = 0;
+    }
+    for(KernelNeighbors it = kernel_neighbors(k, w); kernel_next_neighbor(&it, &x);) {
+        if(_is_private(s, x)) {
+            ls->hits[ls->dominator_xor[x]] = 0;
+        }
+    }
+    return count_redundant;
+}
+
+
+
+// Remove a random ds vertex u and add a vertex w that dominates everything that u dominated privately,
+// if such a w exists. The w that makes the most other ds vertices redundant is chosen, and those are
+// removed as well (a (2,1) swap if there is one, otherwise a (1,1) swap). If there is no such w, the
+// solution stays unchanged.
+static void _ls_step(LocalSearch* ls, IGState* s)
+{
+    const Kernel* k = ls->k;
+    ls->step++;
+    ls->redundant_size = 0;
+    uint32_t u = ls->ds_list[(uint32_t)(((__uint128_t)ls->ds_list_size * (__uint128_t)fast_random(&s->rng)) /
+                                        ((__uint128_t)FAST_RANDOM_MAX + 1))];
+    if(ls->tabu_until[u] > ls->step) {
+        return;
+    }
+    if(ls->loss[u] == 0) { // u is redundant
+        _ls_remove(ls, s, u);
+        return;
+    }
+
+    const uint32_t count_undominated = ls->loss[u];
+    _ls_remove(ls, s, u);
+    // w has to dominate any of the now undominated vertices, so it suffices to look at the neighborhood of one of them
+    uint32_t x0 = u;
+    KernelNeighbors u_neighbors = kernel_neighbors(k, u);
+    while(s->dominated_by_number[x0] != 0 && kernel_next_neighbor(&u_neighbors, &x0)) { // empty loop
+    }
+    assert(s->dominated_by_number[x0] == 0);
+
+    uint32_t best_w = LS_NO_VERTEX;
+    uint32_t best_count_redundant = 0;
+    KernelNeighbors x0_neighbors = kernel_neighbors(k, x0);
+    for(bool is_neighbor = true; is_neighbor;) {
+        uint32_t w = x0; // also consider x0 itself, after its neighbors
+        is_neighbor = kernel_next_neighbor(&x0_neighbors, &w);
+        if(w == u || s->is_in_ds[w] || ls->gain[w] != count_undominated || ls->tabu_until[w] > ls->step) {
+            continue;
+        }
+        uint32_t count_redundant = _ls_count_redundant_after_adding(ls, s, w);
+        if(best_w == LS_NO_VERTEX || count_redundant > best_count_redundant) {
+            best_w = w;
+            best_count_redundant = count_redundant;
+        }
+    }
+
+    if(best_w == LS_NO_VERTEX) { // no swap possible, undo the removal
+        _ls_add(ls, s, u);
+    }
+    else {
+        _ls_add(ls, s, best_w);
+        uint64_t tenure = LS_TABU_TENURE_MIN + fast_random(&s->rng) % LS_TABU_TENURE_RANDOM;
+        ls->tabu_until[u] = ls->step + tenure;
+        ls->tabu_until[best_w] = ls->step + tenure;
+    }
+    // remove all vertices that have become redundant. The loss of a vertex in the list can increase
+    // again when another one is removed, so it has to be checked again.
+    for(uint32_t i = 0; i < ls->redundant_size; i++) {
+        uint32_t d = ls->redundant[i];
+        if(s->is_in_ds[d] && ls->loss[d] == 0) {
+            _ls_remove(ls, s, d);
+        }
+    }
+}
+
+
+
+// Improve the current solution of s (which must be a dominating set and must not be restricted to a
+// region) with max_steps swap moves, or fewer if a stop is requested. The ds size never increases.
+// Returns the resulting ds size, which is also stored in s->current_ds_size.
+size_t ls_run(LocalSearch* ls, IGState* s, size_t max_steps)
+{
+    assert(ls != NULL && s != NULL && s->k == ls->k && s->region == NULL);
+    _ls_init(ls, s);
+#ifdef DEBUG_LOG
+    const size_t ds_size_before = s->current_ds_size;
+#endif
+    for(size_t step = 0; step < max_steps && ls->ds_list_size > 0; step++) {
+        if(step % LS_STOP_CHECK_INTERVAL == LS_STOP_CHECK_INTERVAL - 1 && stop_requested(s->stop)) {
+            break;
+        }
+        _ls_step(ls, s);
+    }
+    debug_log("local search: ds size %zu ==> %zu in %zu steps\n", ds_size_before, s->current_ds_size, max_steps);
+    return s->current_ds_size;
+}
@@ -0,0 +1,40 @@
+#ifndef _LOCAL_SEARCH_H
+#define _LOCAL_SEARCH_H
+
+#include <stddef.h>
+
+#include "kernel.h"
+#include "ig_state.h"
+
+
+
+// Swap based local search on the current solution of an IGState.
+// It evaluates (1,1) swaps (remove one ds vertex, add one other vertex) and (2,1) swaps (remove two ds
+// vertices, add one), using gain and loss scores per vertex that are updated incrementally with every move:
+//  - loss(u) of a ds vertex u: the number of vertices that would become undominated if u was removed
+//  - gain(w) of any other vertex w: the number of undominated vertices w would dominate if it was added
+
+
+
+typedef struct LocalSearch LocalSearch;
+
+
+
+// ls_new may return NULL if not successful. The returned value has to be freed using ls_free(...).
+// All memory is allocated here, ls_run does not allocate anything.
+LocalSearch* ls_new(const Kernel* k);
+
+
+
+void ls_free(LocalSearch* ls);
+
+
+
+// Improve the current solution of s (which must be a dominating set and must not be restricted to a
+// region) with max_steps swap moves, or fewer if a stop is requested. The ds size never increases.
+// Returns the resulting ds size, which is also stored in s->current_ds_size.
+size_t ls_run(LocalSearch* ls, IGState* s, size_t max_steps);
+
+
+
+#endif
@@ -0,0 +1,277 @@
+#define _DEFAULT_SOURCE // for syscall
+#include "perf_counters.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+
+
+// The counters of a thread form one group, which the kernel always schedules together, so that all of them
+// count the same instructions. The group leader is the task clock, a software counter that is always
+// available, and the hardware counters are added to its group if the machine supports them.
+typedef enum PerfEvent {
+    PERF_TASK_CLOCK, // nanoseconds of cpu time
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES, // usually of the last level cache
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES, // data TLB misses of loads
+    PERF_NUM_EVENTS
+} PerfEvent;
+
+
+typedef struct PerfEventType {
+    uint32_t type;
+    uint64_t config;
+    const char* name;
+} PerfEventType;
+
+
+// the value of every counter at one point in time, see _read_sample
+typedef struct PerfSample {
+    uint64_t time_enabled; // the time the group has existed, in nanoseconds
+    uint64_t time_running; // the time the group was actually counting, less if the counters were multiplexed
+    uint64_t values[PERF_NUM_EVENTS];
+} PerfSample;
+
+
+typedef struct PerfTotals {
+    uint64_t sections[PERF_NUM_PHASES]; // the number of measured phases
+    double counts[PERF_NUM_PHASES][PERF_NUM_EVENTS];
+} PerfTotals;
+
+
+typedef struct PerfThread {
+    bool is_open;
+    bool is_measuring;
+    PerfPhase phase; // the current phase if is_measuring
+    int fds[PERF_NUM_EVENTS]; // only of the available events, fds[PERF_TASK_CLOCK] is the group leader
+    PerfSample start;          // of the current phase
+    PerfTotals totals;         // not yet added to the totals of the process
+} PerfThread;
+
+
+
+static const PerfEventType _g_event_types[PERF_NUM_EVENTS] = {
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, "task_clock"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache_misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch_misses"},
+    {PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+     "dtlb_misses"}};
+static const char* const _g_phase_names[PERF_NUM_PHASES] = {"parse",     "redundant", "rule_1",
+                                                            "rule_2",    "construct", "deconstruct"};
+
+static bool _g_enabled = false;
+static bool _g_available[PERF_NUM_EVENTS]; // set by perf_counters_enable
+static PerfTotals _g_totals;               // of the finished threads
+static pthread_mutex_t _g_totals_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local PerfThread _g_thread;
+
+
+
+static int _perf_event_open(PerfEvent event, int group_fd)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = _g_event_types[event].type;
+    attr.config = _g_event_types[event].config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // the calling thread on any cpu
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0UL);
+}
+
+
+
+// open the counters of the calling thread. If is_probe, the events that cannot be opened are marked as
+// unavailable, otherwise this exits on failure. returns false if the group leader could not be opened
+static bool _open_counters(PerfThread* t, bool is_probe)
+{
+    for(int event = 0; event < PERF_NUM_EVENTS; event++) {
+        if(!_g_available[event]) {
+            continue;
+        }
+        t->fds[event] = _perf_event_open((PerfEvent)event, event == PERF_TASK_CLOCK ? -1 : t->fds[PERF_TASK_CLOCK]);
+        if(t->fds[event] < 0) {
+            if(!is_probe) {
+                perror("perf_counters: perf_event_open failed");
+                exit(EXIT_FAILURE);
+            }
+            fprintf(stderr, "perf_counters: %s not available: ", _g_event_types[event].name);
+            perror(NULL);
+            _g_available[event] = false;
+            if(event == PERF_TASK_CLOCK) {
+                return false;
+            }
+        }
+    }
+    t->is_open = true;
+    return true;
+}
+
+
+
+static void _read_sample(const PerfThread* t, PerfSample* sample)
+{
+    uint64_t buffer[3 + PERF_NUM_EVENTS]; // nr, time_enabled, time_running, the values in the order of opening
+    if(read(t->fds[PERF_TASK_CLOCK], buffer, sizeof(buffer)) <= 0) {
+        perror("perf_counters: reading the counters failed");
+        exit(EXIT_FAILURE);
+    }
+    sample->time_enabled = buffer[1];
+    sample->time_running = buffer[2];
+    uint64_t value_idx = 0;
+    for(int event = 0; event < PERF_NUM_EVENTS; event++) {
+        sample->values[event] = _g_available[event] && value_idx < buffer[0] ? buffer[3 + value_idx++] : 0;
+    }
+}
+
+
+
+static void _add_totals(PerfTotals* sum, const PerfTotals* summand)
+{
+    for(int phase = 0; phase < PERF_NUM_PHASES; phase++) {
+        sum->sections[phase] += summand->sections[phase];
+        for(int event = 0; event < PERF_NUM_EVENTS; event++) {
+            sum->counts[phase][event] += summand->counts[phase][event];
+        }
+    }
+}
+
+
+
+// turn the counters on for all threads. Must be called before the phases start and before other threads
+// are created. Prints a warning for every counter that the machine does not support (e.g. the hardware
+// counters in a virtual machine without a PMU), and returns false if the counters cannot be used at all
+// (e.g. if perf_event_paranoid forbids it). The cpu time of the phases is measured in any case.
+bool perf_counters_enable(void)
+{
+    for(int event = 0; event < PERF_NUM_EVENTS; event++) {
+        _g_available[event] = true;
+    }
+    _g_enabled = _open_counters(&_g_thread, true);
+    return _g_enabled;
+}
+
+
+
+// start measuring phase in the calling thread. Phases must not be nested. Does nothing if not enabled.
+void perf_phase_begin(PerfPhase phase)
+{
+    if(!_g_enabled) {
+        return;
+    }
+    PerfThread* t = &_g_thread;
+    assert(!t->is_measuring);
+    if(!t->is_open) {
+        _open_counters(t, false);
+    }
+    t->is_measuring = true;
+    t->phase = phase;
+    _read_sample(t, &(t->start));
+}
+
+
+
+// stop measuring phase in the calling thread and add the counts to its totals
+void perf_phase_end(PerfPhase phase)
+{
+    if(!_g_enabled) {
+        return;
+    }
+    PerfThread* t = &_g_thread;
+    assert(t->is_measuring && t->phase == phase);
+    PerfSample end;
+    _read_sample(t, &end);
+    t->is_measuring = false;
+    // if there were more counters than the cpu has, the kernel multiplexed them, and the counts are
+    // extrapolated from the time the group was running
+    const uint64_t enabled = end.time_enabled - t->start.time_enabled;
+    const uint64_t running = end.time_running - t->start.time_running;
+    const double scale = running > 0 && running < enabled ? (double)enabled / (double)running : 1.0;
+    t->totals.sections[phase]++;
+    for(int event = 0; event < PERF_NUM_EVENTS; event++) {
+        t->totals.counts[phase][event] += scale * (double)(end.values[event] - t->start.values[event]);
+    }
+}
+
+
+
+// add the counts of the calling thread to the totals of the process and close its counters. Must be called
+// before a thread that measured phases exits. A later phase of the thread opens the counters again.
+void perf_counters_thread_finish(void)
+{
+    PerfThread* t = &_g_thread;
+    if(!t->is_open) {
+        return;
+    }
+    assert(!t->is_measuring);
+    pthread_mutex_lock(&_g_totals_lock);
+    _add_totals(&_g_totals, &(t->totals));
+    pthread_mutex_unlock(&_g_totals_lock);
+    memset(&(t->totals), 0, sizeof(PerfTotals));
+    for(int event = PERF_NUM_EVENTS - 1; event >= 0; event--) { // the group leader last
+        if(_g_available[event]) {
+            close(t->fds[event]);
+        }
+    }
+    t->is_open = false;
+}
+
+
+
+// misses (or other counts) per 1000 instructions, "-" if one of the counters is not available
+static void _write_ratio(FILE* file, PerfEvent event, const double* counts, double per, PerfEvent per_event)
+{
+    if(_g_available[event] && _g_available[per_event] && counts[per_event] > 0.0) {
+        fprintf(file, "\t%.3f", per * counts[event] / counts[per_event]);
+    }
+    else {
+        fprintf(file, "\t-");
+    }
+}
+
+
+
+// write the totals of all finished threads and of the calling thread as a table, with the instructions per
+// cycle and the misses per 1000 instructions of each phase. returns false if writing failed
+bool perf_counters_write(FILE* file)
+{
+    perf_counters_thread_finish();
+    fprintf(file, "# phase\tsections\tcpu_seconds");
+    for(int event = PERF_CYCLES; event < PERF_NUM_EVENTS; event++) {
+        fprintf(file, "\t%s", _g_event_types[event].name);
+    }
+    fprintf(file, "\tipc\tcache_mpki\tbranch_mpki\tdtlb_mpki\n");
+    for(int phase = 0; phase < PERF_NUM_PHASES; phase++) {
+        const double* counts = _g_totals.counts[phase];
+        fprintf(file, "%s\t%" PRIu64 "\t%.6f", _g_phase_names[phase], _g_totals.sections[phase],
+                counts[PERF_TASK_CLOCK] * 1e-9);
+        for(int event = PERF_CYCLES; event < PERF_NUM_EVENTS; event++) {
+            if(_g_available[event]) {
+                fprintf(file, "\t%.0f", counts[event]);
+            }
+            else {
+                fprintf(file, "\t-");
+            }
+        }
+        _write_ratio(file, PERF_INSTRUCTIONS, counts, 1.0, PERF_CYCLES);
+        _write_ratio(file, PERF_CACHE_MISSES, counts, 1000.0, PERF_INSTRUCTIONS);
+        _write_ratio(file, PERF_BRANCH_MISSES, counts, 1000.0, PERF_INSTRUCTIONS);
+        _write_ratio(file, PERF_DTLB_MISSES, counts, 1000.0, PERF_INSTRUCTIONS);
+        fprintf(file, "\n");
+    }
+    return !ferror(file);
+}
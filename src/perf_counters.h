@@ -0,0 +1,63 @@
+#ifndef _PERF_COUNTERS_H
+#define _PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+
+
+// Optional profiling with the hardware performance counters of Linux (perf_event_open): cycles, instructions,
+// cache misses, branch misses and data TLB misses, counted separately for the phases of the solver. It shows
+// for example whether the greedy construction or a reduction rule is limited by memory accesses, and helps to
+// validate changes of the data layout without attaching an external profiler.
+// The counters are off unless perf_counters_enable is called, and then phases cost two read system calls
+// each. Only the user space of the measured threads is counted. Every thread opens its own counters at the
+// start of its first phase and adds its counts to the totals of the process in perf_counters_thread_finish.
+
+
+
+// the phases that are measured. Of the reduction rules, only the timed attempts are measured
+// (every REDUCTION_TIMING_INTERVAL-th, see reduction.h), so that measuring does not slow the reduction down.
+typedef enum PerfPhase {
+    PERF_PHASE_PARSE,
+    PERF_PHASE_REDUNDANT,   // the removal of redundant vertices
+    PERF_PHASE_RULE_1,
+    PERF_PHASE_RULE_2,
+    PERF_PHASE_CONSTRUCT,   // the greedy construction, see ig_greedy_vote_construct
+    PERF_PHASE_DECONSTRUCT, // the deconstruction operators of iterated greedy
+    PERF_NUM_PHASES
+} PerfPhase;
+
+
+
+// turn the counters on for all threads. Must be called before the phases start and before other threads
+// are created. Prints a warning for every counter that the machine does not support (e.g. the hardware
+// counters in a virtual machine without a PMU), and returns false if the counters cannot be used at all
+// (e.g. if perf_event_paranoid forbids it). The cpu time of the phases is measured in any case.
+bool perf_counters_enable(void);
+
+
+
+// start measuring phase in the calling thread. Phases must not be nested. Does nothing if not enabled.
+void perf_phase_begin(PerfPhase phase);
+
+
+
+// stop measuring phase in the calling thread and add the counts to its totals
+void perf_phase_end(PerfPhase phase);
+
+
+
+// add the counts of the calling thread to the totals of the process and close its counters. Must be called
+// before a thread that measured phases exits. A later phase of the thread opens the counters again.
+void perf_counters_thread_finish(void);
+
+
+
+// write the totals of all finished threads and of the calling thread as a table, with the instructions per
+// cycle and the misses per 1000 instructions of each phase. returns false if writing failed
+bool perf_counters_write(FILE* file);
+
+
+
+#endif
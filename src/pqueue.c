@@ -10,17 +10,16 @@
 
 
 
-#define PQ_INIT_SIZE        64 // start with enough space for x key value pairs
-#define PQ_REALLOC_FACTOR   2  // multiply the size by x if more space is needed
-#define PQ_REALLOC_DIVISOR  2  // divide the size by x if space is no longer needed
-#define PQ_DEALLOCATE_LIMIT 4  // dealloc space if less than 1/x of the allocated space is needed
+#define PQ_NOT_CONTAINED UINT32_MAX // marker in kv_idx for values that are not in the queue
 
 
 
 struct PQueue {
     KeyValPair* nodes;
+    uint32_t* kv_idx; // for each value the index of its key value pair in nodes, or PQ_NOT_CONTAINED
     size_t n;
-    size_t allocated_n;
+    uint64_t operations; // see pq_operation_count
+    uint32_t max_vals;   // the capacity of nodes and the length of kv_idx
 };
 
 
@@ -43,50 +42,14 @@ static inline size_t _pq_rchild(size_t index)
 
 
 
-static inline void _pq_incr_allocated_n(PQueue* q)
-{
-    size_t factor = PQ_REALLOC_FACTOR;
-    size_t new_n = factor * q->allocated_n;
-    size_t new_size_bytes = new_n * sizeof(KeyValPair);
-    KeyValPair* new_ptr = realloc(q->nodes, new_size_bytes);
-    if(!new_ptr) {
-        fprintf(stderr, "pq: Reallocating %lu bytes to increase the capacity to %lu key value pairs failed.\n",
-                (unsigned long)new_size_bytes, (unsigned long)new_n);
-        // careful if you decide to not exit here: q->nodes is still allocated
-        exit(EXIT_FAILURE);
-    }
-    q->nodes = new_ptr;
-    q->allocated_n = new_n;
-}
-
-
-
-static inline void _pq_decr_allocated_n(PQueue* q)
-{
-    if(q->allocated_n <= 64) {
-        return; // don't even bother
-    }
-    size_t divisor = PQ_REALLOC_DIVISOR;
-    size_t new_n = q->allocated_n / divisor;
-    size_t new_size_bytes = new_n * sizeof(KeyValPair);
-    KeyValPair* new_ptr = realloc(q->nodes, new_size_bytes);
-    if(!new_ptr) { // I don't expect a realloc to a smaller size to ever fail but it is allowed
-        return;
-    }
-    q->nodes = new_ptr;
-    q->allocated_n = new_n;
-}
-
-
-
 static inline void _pq_swap(PQueue* const q, const size_t node_a, const size_t node_b)
 {
     assert(node_a < q->n && node_b < q->n);
     KeyValPair tmp = q->nodes[node_a];
     q->nodes[node_a] = q->nodes[node_b];
     q->nodes[node_b] = tmp;
-    q->nodes[node_a].val->pq_kv_idx = (uint32_t)node_a; // update the indices in the vertex structs
-    q->nodes[node_b].val->pq_kv_idx = (uint32_t)node_b;
+    q->kv_idx[q->nodes[node_a].val] = (uint32_t)node_a; // update the saved indices
+    q->kv_idx[q->nodes[node_b].val] = (uint32_t)node_b;
 }
 
 
@@ -121,35 +84,56 @@ static inline void _pq_heapify_node(PQueue* q, size_t node)
 
 
 
-PQueue* pq_new(void)
+PQueue* pq_new(uint32_t max_vals)
 {
     PQueue* q = malloc(sizeof(PQueue));
     if(!q) {
         return NULL;
     }
-    q->nodes = malloc(PQ_INIT_SIZE * sizeof(KeyValPair));
-    if(!q->nodes) {
+    size_t capacity = max_vals > 0 ? max_vals : 1; // avoid malloc(0)
+    q->nodes = malloc(capacity * sizeof(KeyValPair));
+    q->kv_idx = malloc(capacity * sizeof(uint32_t));
+    if(!q->nodes || !q->kv_idx) {
+        free(q->nodes);
+        free(q->kv_idx);
         free(q);
         return NULL;
     }
-    q->allocated_n = PQ_INIT_SIZE;
+    for(uint32_t val = 0; val < max_vals; val++) {
+        q->kv_idx[val] = PQ_NOT_CONTAINED;
+    }
+    q->max_vals = max_vals;
     q->n = 0;
+    q->operations = 0;
     return q;
 }
 
 
 
 // Free any internal pointers belonging to the PQueue struct and q itself.
-// This does not free pointers that are still saved in the queue.
 void pq_free(PQueue* q)
 {
     free(q->nodes);
     q->nodes = NULL;
+    free(q->kv_idx);
+    q->kv_idx = NULL;
     free(q);
 }
 
 
 
+// Remove all elements from q but keep the allocated space.
+void pq_clear(PQueue* q)
+{
+    assert(q != NULL);
+    for(size_t i = 0; i < q->n; i++) {
+        q->kv_idx[q->nodes[i].val] = PQ_NOT_CONTAINED;
+    }
+    q->n = 0;
+}
+
+
+
 bool pq_is_empty(const PQueue* q)
 {
     return q->n == 0;
@@ -157,18 +141,24 @@ bool pq_is_empty(const PQueue* q)
 
 
 
+bool pq_contains(const PQueue* q, uint32_t val)
+{
+    assert(val < q->max_vals);
+    return q->kv_idx[val] != PQ_NOT_CONTAINED;
+}
+
+
+
 void pq_insert(PQueue* q, const KeyValPair new)
 {
     assert(q != NULL);
-    assert(!(new.val->is_in_pq));
-    new.val->is_in_pq = true;
-    if(q->n == q->allocated_n) {
-        _pq_incr_allocated_n(q);
-    }
+    assert(!pq_contains(q, new.val));
+    assert(q->n < q->max_vals); // cannot overflow because every value is contained at most once
     size_t idx_new = q->n;
     q->n++;
+    q->operations++;
     q->nodes[idx_new] = new;
-    q->nodes[idx_new].val->pq_kv_idx = (uint32_t)idx_new; // set the index saved in the vertex struct
+    q->kv_idx[new.val] = (uint32_t)idx_new;
     while(idx_new != 0 && new.key > q->nodes[_pq_parent(idx_new)].key) {
         size_t idx_parent = _pq_parent(idx_new);
         _pq_swap(q, idx_new, idx_parent);
@@ -193,48 +183,54 @@ KeyValPair pq_pop(PQueue* q)
     assert(q->n > 0);
     KeyValPair result = q->nodes[0];
     q->n--;
+    q->operations++;
     if(q->n != 0) {
         q->nodes[0] = q->nodes[q->n];
-        q->nodes[0].val->pq_kv_idx = 0;
+        q->kv_idx[q->nodes[0].val] = 0;
         _pq_heapify_node(q, 0);
     }
-    if(q->n < q->allocated_n / PQ_DEALLOCATE_LIMIT) {
-        _pq_decr_allocated_n(q);
-    }
-    result.val->is_in_pq = false;
+    q->kv_idx[result.val] = PQ_NOT_CONTAINED;
     return result;
 }
 
 
 
-// get the current priority of a vertex
-pq_keytype pq_get_key(const PQueue* q, const Vertex* v)
+// get the current priority of a value
+pq_keytype pq_get_key(const PQueue* q, uint32_t val)
 {
-    assert(q != NULL && v != NULL);
-    assert(v->is_in_pq);
-    assert(v->pq_kv_idx < q->n);
-    return q->nodes[v->pq_kv_idx].key;
+    assert(q != NULL);
+    assert(pq_contains(q, val));
+    assert(q->kv_idx[val] < q->n);
+    return q->nodes[q->kv_idx[val]].key;
 }
 
 
 
-// v must be contained in q
-// May ONLY be used to decrease the priority of a vertex, i.e. make it come out later than it would without changing.
-void pq_decrease_priority(PQueue* q, Vertex* v, const pq_keytype new_key)
+// val must be contained in q
+// May ONLY be used to decrease the priority of a value, i.e. make it come out later than it would without changing.
+void pq_decrease_priority(PQueue* q, uint32_t val, const pq_keytype new_key)
 {
     assert(q != NULL);
-    assert(v != NULL);
-    assert(v->is_in_pq);
+    assert(pq_contains(q, val));
 #ifndef NDEBUG
-    pq_keytype old_key = q->nodes[v->pq_kv_idx].key; // this variable is only used for asserts
+    pq_keytype old_key = q->nodes[q->kv_idx[val]].key; // this variable is only used for asserts
     assert(old_key > new_key);
 #endif
 
-    const size_t idx = v->pq_kv_idx;
+    const size_t idx = q->kv_idx[val];
     assert(idx < q->n);
-    assert(q->nodes[idx].val == v);
+    assert(q->nodes[idx].val == val);
     q->nodes[idx].key = new_key;
     _pq_heapify_node(q, idx);
+    q->operations++;
 
-    assert_allow_float_equal(q->nodes[v->pq_kv_idx].key == new_key); // does not prove that v->pq_kv_idx is set correctly, but it is definitely not correct if this fails
+    assert_allow_float_equal(q->nodes[q->kv_idx[val]].key == new_key); // does not prove that kv_idx is set correctly, but it is definitely not correct if this fails
+}
+
+
+
+// the number of inserts, pops and priority decreases on q since pq_new, for the stats of a solve
+uint64_t pq_operation_count(const PQueue* q)
+{
+    return q->operations;
 }
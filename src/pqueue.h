@@ -3,12 +3,14 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 
-#include "graph.h"
 
 
-
-// Array based max heap implementation of a priority queue
+// Array based max heap implementation of a priority queue.
+// The values are vertex indices in [0, max_vals). Each value can be contained at most once. The queue
+// keeps track of the position of every value in the heap itself, so several queues can be used on the
+// same vertices at the same time (e.g. by different threads).
 
 
 
@@ -21,7 +23,7 @@ typedef PQ_KEY_TYPE pq_keytype;
 
 typedef struct KeyValPair {
     pq_keytype key;
-    struct Vertex* val;
+    uint32_t val;
 } KeyValPair;
 
 
@@ -30,17 +32,23 @@ typedef struct PQueue PQueue;
 
 // pq_new may return NULL if not successful. The returned value has to be freed using
 // pq_free(...) if it is not NULL.
-PQueue* pq_new(void);
+// All memory is allocated here, no operation on the queue allocates anything later on.
+PQueue* pq_new(uint32_t max_vals);
 
 // Free any internal pointers belonging to the PQueue struct and q itself.
-// This does not free pointers that are still saved in the queue.
 void pq_free(PQueue* q);
 
+// Remove all elements from q but keep the allocated space.
+void pq_clear(PQueue* q);
+
 // Returns true iff q is empty.
 bool pq_is_empty(const PQueue* q);
 
+// Returns true iff val is currently contained in q.
+bool pq_contains(const PQueue* q, uint32_t val);
+
 // inserts KeyValPair new into q
-// q does NOT take ownership over any pointer in the key value pair
+// new.val must not already be contained in q
 void pq_insert(PQueue* q, const KeyValPair new);
 
 // Get the KeyValPair with the greatest priority without removing it from q.
@@ -51,11 +59,14 @@ KeyValPair pq_peek(const PQueue* q);
 // Must not be called on an empty PQueue
 KeyValPair pq_pop(PQueue* q);
 
-// get the current priority of a vertex
-pq_keytype pq_get_key(const PQueue* q, const struct Vertex* v);
+// get the current priority of a value
+pq_keytype pq_get_key(const PQueue* q, uint32_t val);
+
+// May ONLY be used to decrease the priority of a value, i.e. make it come out later than it would without changing.
+void pq_decrease_priority(PQueue* q, uint32_t val, const pq_keytype new_key);
 
-// May ONLY be used to decrease the priority of a vertex, i.e. make it come out later than it would without changing.
-void pq_decrease_priority(PQueue* q, struct Vertex* v, const pq_keytype new_key);
+// the number of inserts, pops and priority decreases on q since pq_new, for the stats of a solve
+uint64_t pq_operation_count(const PQueue* q);
 
 
 
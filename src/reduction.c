@@ -3,10 +3,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
-#include <time.h>
 #include <stdio.h>
 
 #include "debug_log.h"
+#include "perf_counters.h"
 
 
 
@@ -46,12 +46,72 @@ static void _mark_vertex_removed(Graph* g, Vertex* v)
     assert(!(v->is_removed)); // wouldn't be a problem but it's a sign something went wrong
     if(!(v->is_removed)) {
         v->is_removed = true;
+        g->removed_count++;
         _remove_edges(g, v);
     }
 }
 
 
 
+// marks all vertices in the array removed, like _mark_vertex_removed for each of them (skipping those that already
+// are). Instead of searching the neighbors array of a remaining neighbor once per removed vertex, it is compacted once,
+// so removing the d leaves of a vertex takes O(d) instead of O(d^2) time.
+// may change neighbor tags of the remaining neighbors
+static void _mark_vertices_removed(Graph* g, Vertex** vertices, size_t count)
+{
+    Vertex* tag_vertex = NULL; // its id marks the compacted neighbors, it is no longer an existing vertex
+    for(size_t i = 0; i < count; i++) {
+        Vertex* v = vertices[i];
+        if(!(v->is_removed)) {
+            v->is_removed = true;
+            g->removed_count++;
+            tag_vertex = v;
+        }
+    }
+    if(tag_vertex == NULL) {
+        return;
+    }
+    // vertices removed before have no edges left, so a removed neighbor is one of the vertices
+    for(size_t i = 0; i < count; i++) {
+        Vertex* v = vertices[i];
+        for(uint32_t i_v = 0; i_v < v->degree; i_v++) {
+            v->neighbors[i_v]->neighbor_tag = 0;
+        }
+    }
+    uint64_t inner_edge_ends = 0; // edges between two of the vertices are seen from both ends
+    for(size_t i = 0; i < count; i++) {
+        Vertex* v = vertices[i];
+        for(uint32_t i_v = 0; i_v < v->degree; i_v++) {
+            Vertex* u = v->neighbors[i_v];
+            if(u->is_removed) {
+                inner_edge_ends++;
+                continue;
+            }
+            if(u->neighbor_tag == tag_vertex->id) { // already compacted
+                continue;
+            }
+            u->neighbor_tag = tag_vertex->id;
+            uint32_t kept = 0;
+            for(uint32_t i_u = 0; i_u < u->degree; i_u++) {
+                if(!(u->neighbors[i_u]->is_removed)) {
+                    u->neighbors[kept++] = u->neighbors[i_u];
+                }
+            }
+            g->m -= u->degree - kept;
+            u->degree = kept;
+        }
+    }
+    g->m -= inner_edge_ends / 2;
+    for(size_t i = 0; i < count; i++) {
+        Vertex* v = vertices[i];
+        v->degree = 0;
+        free(v->neighbors);
+        v->neighbors = NULL;
+    }
+}
+
+
+
 // deletes the Vertex pointer at vertices_idx from g->vertices and frees it, then moves the last
 // pointer in g->vertices to this index, and updates g->n;
 // must be called on a vertex only if it has beed marked removed using _mark_vertex_removed before
@@ -224,8 +284,8 @@ static void _fix_vertices_and_mark_removed(Graph* g, Vertex* v, Vertex* w)
     _mark_neighbors_dominated(w);
 
     // save the array of neighbors
-    uint32_t count_neighbors = v->degree + w->degree;
-    Vertex** neighbors = malloc((size_t)count_neighbors * sizeof(Vertex*));
+    size_t count_neighbors = (size_t)v->degree + w->degree;
+    Vertex** neighbors = malloc(count_neighbors * sizeof(Vertex*));
     if(!neighbors) {
         perror("_fix_vertices_and_mark_removed: malloc failed");
         exit(EXIT_FAILURE);
@@ -236,7 +296,7 @@ static void _fix_vertices_and_mark_removed(Graph* g, Vertex* v, Vertex* w)
     _mark_vertex_removed(g, v); // after this point, v->degree == 0 and v->neighbors == NULL
     _mark_vertex_removed(g, w); // after this point, w->degree == 0 and w->neighbors == NULL
 
-    for(uint32_t i = 0; i < count_neighbors; i++) {
+    for(size_t i = 0; i < count_neighbors; i++) {
         if((!neighbors[i]->is_removed) && _is_redundant(neighbors[i])) {
             _mark_vertex_removed(g, neighbors[i]);
         }
@@ -440,12 +500,8 @@ static bool _rule_1_reduce_vertex(Graph* g, Vertex* v)
 
     if(reduce) {
         // v can be rule-1-reduced, now do it
-        for(size_t i = 0; i < count_n2_only; i++) {
-            _mark_vertex_removed(g, n2_only[i]);
-        }
-        for(size_t i = 0; i < count_n2_n3_mixed; i++) {
-            _mark_vertex_removed(g, n2_n3_mixed[i]);
-        }
+        _mark_vertices_removed(g, n2_only, count_n2_only);
+        _mark_vertices_removed(g, n2_n3_mixed, count_n2_n3_mixed);
         _fix_vertex_and_mark_removed(g, v);
         free(n2_only);
         return true;
@@ -484,12 +540,12 @@ static bool _rule_2_reduce_vertices(Graph* g, Vertex* v, Vertex* w)
     assert(v != w && v->id != w->id);
 
     // setup
-    Vertex** n2 = malloc(2 * (size_t)(v->degree + w->degree) * sizeof(Vertex*)); // block allocation for n2 and n3
+    Vertex** n2 = malloc(2 * ((size_t)v->degree + w->degree) * sizeof(Vertex*)); // block allocation for n2 and n3
     if(!n2) {
         perror("_rule_2_reduce_vertices: malloc failed");
         exit(EXIT_FAILURE);
     }
-    Vertex** n3 = &(n2[v->degree + w->degree]);
+    Vertex** n3 = &(n2[(size_t)v->degree + w->degree]);
     size_t count_n1 = 0, count_n2 = 0, count_n3 = 0; // the number of elements in the arrays
 
     // tag all vertices in N[v,w]
@@ -625,33 +681,28 @@ static bool _rule_2_reduce_vertices(Graph* g, Vertex* v, Vertex* w)
         }
 
 
-        if(remove_n3) {
-            for(size_t i = 0; i < count_n3; i++) {
-                if(!(n3[i]->is_removed)) {
-                    _mark_vertex_removed(g, n3[i]);
-                }
+        // collect the removed part of N2 at the start of n2 and append N3, so that they are removed together
+        size_t count_removed = 0;
+        if(remove_n2_w) {
+            for(size_t i = 0; i < w->degree; i++) {
+                w->neighbors[i]->neighbor_tag = w->id;
             }
         }
-        if(remove_n2_v) {
+        if(remove_n2_v) { // after w, so that the common neighbors of v and w are tagged with v's id
             for(size_t i = 0; i < v->degree; i++) {
                 v->neighbors[i]->neighbor_tag = v->id;
             }
-            for(size_t i = 0; i < count_n2; i++) {
-                if((!n2[i]->is_removed) && n2[i]->neighbor_tag == v->id) {
-                    _mark_vertex_removed(g, n2[i]);
-                }
-            }
         }
-        if(remove_n2_w) {
-            for(size_t i = 0; i < w->degree; i++) {
-                w->neighbors[i]->neighbor_tag = w->id;
-            }
-            for(size_t i = 0; i < count_n2; i++) {
-                if((!n2[i]->is_removed) && n2[i]->neighbor_tag == w->id) {
-                    _mark_vertex_removed(g, n2[i]);
-                }
+        for(size_t i = 0; i < count_n2; i++) {
+            if((remove_n2_v && n2[i]->neighbor_tag == v->id) || (remove_n2_w && n2[i]->neighbor_tag == w->id)) {
+                n2[count_removed++] = n2[i];
             }
         }
+        if(remove_n3) { // n2 has room for N2 and N3 together
+            memmove(&(n2[count_removed]), n3, count_n3 * sizeof(Vertex*));
+            count_removed += count_n3;
+        }
+        _mark_vertices_removed(g, n2, count_removed);
         if(fix_v && fix_w) {
             _fix_vertices_and_mark_removed(g, v, w);
         }
@@ -670,29 +721,76 @@ static bool _rule_2_reduce_vertices(Graph* g, Vertex* v, Vertex* w)
 
 
 
-void reduce(Graph* g, float time_budget_total, float time_budget_rule2)
+// one attempt to apply a rule, see _attempt_start and _attempt_end
+typedef struct RuleAttempt {
+    ReductionRuleStats* rule;
+    PerfPhase phase;
+    double start; // negative if the attempt is not timed
+    uint32_t removed_count_before;
+} RuleAttempt;
+
+
+
+// the phase of each rule in the hardware counter profile, see perf_counters.h
+static const PerfPhase _g_rule_phases[REDUCTION_NUM_RULES] = {PERF_PHASE_REDUNDANT, PERF_PHASE_RULE_1, PERF_PHASE_RULE_2};
+
+
+
+// the timed attempts are also measured by the hardware counters, if they are enabled
+static inline RuleAttempt _attempt_start(ReductionRuleStats* rule_stats, ReductionRule rule, const Graph* g)
+{
+    const bool is_timed = rule_stats[rule].attempts++ % REDUCTION_TIMING_INTERVAL == 0;
+    RuleAttempt attempt = {.rule = &(rule_stats[rule]),
+                           .phase = _g_rule_phases[rule],
+                           .start = is_timed ? scheduler_now() : -1.0,
+                           .removed_count_before = g->removed_count};
+    if(is_timed) {
+        perf_phase_begin(attempt.phase);
+    }
+    return attempt;
+}
+
+
+
+// returns success
+static inline bool _attempt_end(const RuleAttempt* attempt, const Graph* g, bool success)
 {
-    assert(time_budget_total >= time_budget_rule2);
-    const clock_t start_time = clock();
-    const clock_t deadline_total = start_time + (clock_t)(time_budget_total * CLOCKS_PER_SEC);
-    const clock_t deadline_rule2 = start_time + (clock_t)(time_budget_rule2 * CLOCKS_PER_SEC);
-    const clock_t deadline_redundant = start_time + (clock_t)(1.1 * time_budget_total * CLOCKS_PER_SEC);
+    if(success) {
+        attempt->rule->successes++;
+        attempt->rule->vertices_removed += g->removed_count - attempt->removed_count_before;
+    }
+    if(attempt->start >= 0.0) {
+        perf_phase_end(attempt->phase);
+        attempt->rule->timed_attempts++;
+        attempt->rule->timed_seconds += scheduler_now() - attempt->start;
+    }
+    return success;
+}
+
+
+
+bool reduce(Graph* g, Scheduler* sch, const StopCondition* stop, ReductionRuleStats* rule_stats)
+{
+    scheduler_start_reduction(sch, (size_t)g->n + g->m);
     size_t loop_iteration = 0;
-    bool time_remaining_total = true, time_remaining_rule2 = true, time_remaining_redundant = true;
+    ReductionAllowance allowed = {.rule2 = true, .rule1 = true, .redundant = true};
 
     bool another_loop = true;
+    bool all_allowed = true; // if every rule was allowed during the whole last loop
     while(another_loop) {
         another_loop = false;
+        all_allowed = allowed.rule2 && allowed.rule1 && allowed.redundant;
         uint32_t next_vertices_idx;
         for(uint32_t vertices_idx = 0; vertices_idx < g->n; vertices_idx = next_vertices_idx) {
             Vertex* v = g->vertices[vertices_idx];
             next_vertices_idx = vertices_idx + 1;
 
             if((loop_iteration++ % 256) == 0) {
-                clock_t current_time = clock();
-                time_remaining_total = current_time < deadline_total;
-                time_remaining_rule2 = current_time < deadline_rule2;
-                time_remaining_redundant = current_time < deadline_redundant;
+                allowed = scheduler_reduction_check(sch, (size_t)g->n + g->m);
+                all_allowed = all_allowed && allowed.rule2 && allowed.rule1 && allowed.redundant;
+                if(stop_requested(stop)) { // the removed vertices are not deleted anymore, see reduction.h
+                    return false;
+                }
             }
 
             if(v->is_removed) {
@@ -700,36 +798,53 @@ void reduce(Graph* g, float time_budget_total, float time_budget_rule2)
                 next_vertices_idx = vertices_idx; // stay, a new pointer was just moved there
                 continue;
             }
-            if(!time_remaining_redundant) {
+            if(!allowed.redundant) {
                 continue;
             }
-            else if(v->dominated_by_number > 0 && _is_redundant(v)) {
-                _mark_vertex_removed(g, v);
-                another_loop = true;
-                continue;
+            else if(v->dominated_by_number > 0) {
+                const RuleAttempt attempt = _attempt_start(rule_stats, REDUCTION_REDUNDANT, g);
+                const bool is_redundant = _is_redundant(v);
+                if(is_redundant) {
+                    _mark_vertex_removed(g, v);
+                }
+                if(_attempt_end(&attempt, g, is_redundant)) {
+                    another_loop = true;
+                    continue;
+                }
             }
-            if(!time_remaining_total) {
+            if(!allowed.rule1) {
                 continue;
             }
-            else if(_rule_1_reduce_vertex(g, v)) {
+            const RuleAttempt attempt = _attempt_start(rule_stats, REDUCTION_RULE_1, g);
+            if(_attempt_end(&attempt, g, _rule_1_reduce_vertex(g, v))) {
                 another_loop = true;
                 continue;
             }
 
-            if(time_remaining_rule2) {
+            if(allowed.rule2) {
                 // I think this is inefficient but every other way of doing it that I have tried so far was slower in practice
+                // The pairs of a high degree vertex can take long, so the stop request is also checked in between.
+                size_t pair_count = 0;
                 for(uint32_t i = 0; (!v->is_removed) && i < v->degree;) {
                     Vertex* u1 = v->neighbors[i++];
                     assert(!u1->is_removed);
-                    if(_rule_2_reduce_vertices(g, v, u1)) {
+                    const RuleAttempt attempt_v_u1 = _attempt_start(rule_stats, REDUCTION_RULE_2, g);
+                    if(_attempt_end(&attempt_v_u1, g, _rule_2_reduce_vertices(g, v, u1))) {
                         another_loop = true;
                         i--; // stay at this index
                         continue;
                     }
                     for(uint32_t j = i; (!v->is_removed) && j < v->degree; j++) {
+                        if(++pair_count % REDUCTION_PAIR_STOP_CHECK_INTERVAL == 0 && stop_requested(stop)) {
+                            return false;
+                        }
                         Vertex* u2 = v->neighbors[j];
                         assert(u1 != u2 && u1 != v && u2 != v);
-                        if((!u1->is_removed) && (!u2->is_removed) && _rule_2_reduce_vertices(g, u1, u2)) {
+                        if(u1->is_removed || u2->is_removed) {
+                            continue;
+                        }
+                        const RuleAttempt attempt_u1_u2 = _attempt_start(rule_stats, REDUCTION_RULE_2, g);
+                        if(_attempt_end(&attempt_u1_u2, g, _rule_2_reduce_vertices(g, u1, u2))) {
                             another_loop = true;
                             i = 0;
                             break;
@@ -739,4 +854,5 @@ void reduce(Graph* g, float time_budget_total, float time_budget_rule2)
             }
         }
     }
+    return all_allowed;
 }
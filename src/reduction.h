@@ -2,6 +2,7 @@
 #define _REDUCTION_H
 
 #include "graph.h"
+#include "scheduler.h"
 
 
 // implementation of the (slightly modified) reduction rules presented in
@@ -10,7 +11,37 @@
 
 
 
-void reduce(Graph* g, float time_budget_total, float time_budget_rule2);
+#define REDUCTION_TIMING_INTERVAL 16 // only every x-th attempt of a rule is timed, because most attempts take less than a microsecond
+#define REDUCTION_PAIR_STOP_CHECK_INTERVAL 64 // rule 2 checks for a stop request after every x pairs of neighbors of a vertex
+
+
+
+typedef enum ReductionRule {
+    REDUCTION_REDUNDANT, // the removal of redundant dominated vertices
+    REDUCTION_RULE_1,
+    REDUCTION_RULE_2,
+    REDUCTION_NUM_RULES
+} ReductionRule;
+
+
+// what the reduction did with one rule, summed over all calls of reduce
+typedef struct ReductionRuleStats {
+    uint64_t attempts;
+    uint64_t successes;
+    uint64_t vertices_removed; // by the successful attempts, including the vertices that were fixed
+    uint64_t timed_attempts;   // every REDUCTION_TIMING_INTERVAL-th attempt
+    double timed_seconds;      // the wall clock time of the timed attempts
+} ReductionRuleStats;
+
+
+
+// reduces g until no rule can be applied anymore, the scheduler stops the reduction, or a stop is requested.
+// The reduction deadlines are counted from the start of each call, see scheduler.h.
+// After a stop request it returns at once, without deleting the vertices that are marked removed from
+// g->vertices, so that the caller can answer quickly. Then g is only valid for graph_free and its streaming ds.
+// rule_stats has REDUCTION_NUM_RULES entries, indexed by ReductionRule, and the attempts are added to them.
+// returns true if no rule can be applied anymore, i.e. the result does not depend on the time budget
+bool reduce(Graph* g, Scheduler* sch, const StopCondition* stop, ReductionRuleStats* rule_stats);
 
 
 
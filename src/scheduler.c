@@ -0,0 +1,131 @@
+#include "scheduler.h"
+
+#include <time.h>
+#include <assert.h>
+#include <stdio.h>
+
+#include "debug_log.h"
+
+
+
+// reduction deadlines for a budget of SCHEDULER_DEFAULT_BUDGET seconds, scaled linearly for other budgets.
+// 7.5 seconds to try all rules including rule 2, then 5.5 more seconds for rule 1, then 10% more for the
+// removal of redundant vertices.
+#define REDUCTION_BASE_SECONDS_RULE2     7.5
+#define REDUCTION_BASE_SECONDS_RULE1     13.0
+#define REDUCTION_BASE_SECONDS_REDUNDANT 14.3
+#define REDUCTION_BASE_SECONDS_WINDOW    0.5 // the reduction progress is measured over windows of x seconds
+
+#define REDUCTION_MAX_SHARE    0.25 // the reduction may use at most this share of the budget, including the extensions
+#define REDUCTION_MIN_PROGRESS 0.01 // the deadlines are extended while a window shrinks the graph by at least x
+
+
+
+static double _max(double a, double b)
+{
+    return a > b ? a : b;
+}
+
+
+
+static double _min(double a, double b)
+{
+    return a < b ? a : b;
+}
+
+
+
+// monotonic wall clock time in seconds
+double scheduler_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1.e-9 * (double)ts.tv_nsec;
+}
+
+
+
+// budget is the total wall clock time in seconds, counted from now. Use SCHEDULER_DEFAULT_BUDGET if the
+// time limit of the run is not known.
+void scheduler_init(Scheduler* sch, double budget)
+{
+    assert(budget > 0.0);
+    sch->start = scheduler_now();
+    sch->budget = budget;
+    scheduler_start_reduction(sch, 0);
+}
+
+
+
+// the length of the base reduction phases and the windows scales with the budget
+static double _scaled(const Scheduler* sch, double base_seconds)
+{
+    return base_seconds * sch->budget / SCHEDULER_DEFAULT_BUDGET;
+}
+
+
+
+// start a reduction on a graph of the given size (number of vertices plus number of edges), counting the
+// reduction deadlines from now
+void scheduler_start_reduction(Scheduler* sch, size_t size)
+{
+    const double now = scheduler_now();
+    // a reduction that is started again late still gets its base time, the share only limits the extensions
+    sch->reduction_deadline_max = _max(sch->start + REDUCTION_MAX_SHARE * sch->budget,
+                                       now + _scaled(sch, REDUCTION_BASE_SECONDS_REDUNDANT));
+    sch->reduction_deadline_rule2 = now + _scaled(sch, REDUCTION_BASE_SECONDS_RULE2);
+    sch->reduction_deadline_rule1 = now + _scaled(sch, REDUCTION_BASE_SECONDS_RULE1);
+    sch->reduction_deadline_redundant = now + _scaled(sch, REDUCTION_BASE_SECONDS_REDUNDANT);
+    sch->reduction_window_end = now + _scaled(sch, REDUCTION_BASE_SECONDS_WINDOW);
+    sch->reduction_window_start_size = size;
+}
+
+
+
+// extend deadline by one window if it ends within the next window
+static void _extend(const Scheduler* sch, double* deadline, double now, double window)
+{
+    if(*deadline < now + window) {
+        *deadline = _min(sch->reduction_deadline_max, now + window);
+    }
+}
+
+
+
+// called regularly by the reduction with the current size of the graph. Returns which rules may still be
+// applied. Measures the reduction progress and extends the deadlines if it is still high.
+ReductionAllowance scheduler_reduction_check(Scheduler* sch, size_t size)
+{
+    const double now = scheduler_now();
+    if(now >= sch->reduction_window_end) {
+        const double window = _scaled(sch, REDUCTION_BASE_SECONDS_WINDOW);
+        const size_t removed = sch->reduction_window_start_size > size ? sch->reduction_window_start_size - size : 0;
+        const bool fast_progress = (double)removed >= REDUCTION_MIN_PROGRESS * (double)sch->reduction_window_start_size;
+        if(fast_progress) {
+            // only the rules that were still running in the last window can have caused the progress
+            if(now < sch->reduction_deadline_rule2) {
+                _extend(sch, &sch->reduction_deadline_rule2, now, window);
+            }
+            if(now < sch->reduction_deadline_rule1) {
+                _extend(sch, &sch->reduction_deadline_rule1, now, window);
+                _extend(sch, &sch->reduction_deadline_redundant, now, 1.1 * window);
+            }
+        }
+        debug_log("reduction window: size %zu -> %zu, %s\n", sch->reduction_window_start_size, size,
+                  fast_progress ? "fast progress" : "slow progress");
+        sch->reduction_window_end = now + window;
+        sch->reduction_window_start_size = size;
+    }
+    ReductionAllowance allowance = {.rule2 = now < sch->reduction_deadline_rule2,
+                                    .rule1 = now < sch->reduction_deadline_rule1,
+                                    .redundant = now < sch->reduction_deadline_redundant};
+    return allowance;
+}
+
+
+
+// seconds of the budget that are left, can be negative
+double scheduler_remaining(const Scheduler* sch)
+{
+    return sch->start + sch->budget - scheduler_now();
+}
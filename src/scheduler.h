@@ -0,0 +1,127 @@
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+
+
+// Distributes the wall clock budget of the whole run between the phases. All times are measured with a
+// monotonic clock in seconds.
+// The reduction gets base deadlines proportional to the budget, and they are extended as long as the
+// reduction keeps shrinking the graph quickly, up to a maximum share of the budget. Everything that is left
+// goes to the search, which itself splits its time between iterated greedy and local search phases according
+// to their measured improvement rates (see PhaseRate).
+
+
+
+#define SCHEDULER_DEFAULT_BUDGET 300.0 // seconds, the time limit of the PACE 2025 heuristic track
+
+
+
+typedef struct ReductionAllowance {
+    bool rule2;     // the pairwise rule 2, which is the most expensive one
+    bool rule1;     // rule 1 and the cheap vertex rules
+    bool redundant; // the removal of redundant vertices
+} ReductionAllowance;
+
+
+typedef struct Scheduler {
+    double start;  // when the scheduler was initialized
+    double budget; // total wall clock seconds, counted from start
+    // the current reduction deadlines, which may be extended up to reduction_deadline_max
+    double reduction_deadline_rule2;
+    double reduction_deadline_rule1;
+    double reduction_deadline_redundant;
+    double reduction_deadline_max;
+    // progress measurement of the reduction: the size of the graph at the start of the current window
+    double reduction_window_end;
+    size_t reduction_window_start_size;
+} Scheduler;
+
+
+
+// When a run has to stop and output its best solution. Every phase checks it regularly.
+// The flag is set asynchronously, e.g. by a signal handler or by another thread. Several runs can share a
+// flag, so reaching the deadline of one run does not set it.
+typedef struct StopCondition {
+    const atomic_bool* flag; // must not be NULL
+    double deadline;         // monotonic time (see scheduler_now), DBL_MAX if there is none
+} StopCondition;
+
+
+
+// Progress of one phase of an alternating search, as an exponentially decaying sum of the progress made
+// (for example the decrease of the ds size) and of the seconds spent on it.
+typedef struct PhaseRate {
+    double progress;
+    double seconds;
+} PhaseRate;
+
+
+
+// monotonic wall clock time in seconds
+double scheduler_now(void);
+
+
+
+// checked in every iteration of the solvers, so it is inline and the flag only needs a relaxed load.
+// Reading the clock takes a few nanoseconds, so very short loops should only call this every few iterations.
+static inline bool stop_requested(const StopCondition* stop)
+{
+    return atomic_load_explicit(stop->flag, memory_order_relaxed) || scheduler_now() >= stop->deadline;
+}
+
+
+
+// budget is the total wall clock time in seconds, counted from now. Use SCHEDULER_DEFAULT_BUDGET if the
+// time limit of the run is not known.
+void scheduler_init(Scheduler* sch, double budget);
+
+
+
+// start a reduction on a graph of the given size (number of vertices plus number of edges), counting the
+// reduction deadlines from now
+void scheduler_start_reduction(Scheduler* sch, size_t size);
+
+
+
+// called regularly by the reduction with the current size of the graph. Returns which rules may still be
+// applied. Measures the reduction progress and extends the deadlines if it is still high.
+ReductionAllowance scheduler_reduction_check(Scheduler* sch, size_t size);
+
+
+
+// seconds of the budget that are left, can be negative
+double scheduler_remaining(const Scheduler* sch);
+
+
+
+// add the progress made in seconds to the phase
+static inline void phase_rate_add(PhaseRate* rate, double progress, double seconds)
+{
+    rate->progress += progress;
+    rate->seconds += seconds;
+}
+
+
+
+// let older measurements count less, factor must be in (0, 1]
+static inline void phase_rate_decay(PhaseRate* rate, double factor)
+{
+    rate->progress *= factor;
+    rate->seconds *= factor;
+}
+
+
+
+// progress per second, 0 if nothing was measured yet
+static inline double phase_rate_get(const PhaseRate* rate)
+{
+    return rate->seconds > 0.0 ? rate->progress / rate->seconds : 0.0;
+}
+
+
+
+#endif
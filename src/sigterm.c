@@ -0,0 +1,59 @@
+#include "sigterm.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <signal.h>
+
+
+
+static atomic_bool _g_sigterm_received = false;
+
+
+
+static void _sigterm_handler(int sig)
+{
+    (void)sig; // supress warning for unused parameter
+    atomic_store(&_g_sigterm_received, true);
+}
+
+
+
+static void _register(int flags)
+{
+    struct sigaction sa = {0};
+    sa.sa_handler = _sigterm_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = flags;
+    if(sigaction(SIGTERM, &sa, NULL) == -1) {
+        perror("sigaction failed to register SIGTERM handler");
+        exit(EXIT_FAILURE);
+    }
+    if(sigaction(SIGINT, &sa, NULL) == -1) { // also terminate on Ctrl+C
+        // don't care if registering the SIGINT handler fails, it is not necessary but only QOL
+    }
+}
+
+
+
+// register the handler that sets the flag returned by sigterm_flag(). Exits on failure.
+void sigterm_register_handler(void)
+{
+    _register(SA_RESTART); // restart interrupted syscalls
+}
+
+
+
+// like sigterm_register_handler, but a blocking read (e.g. getline on stdin) that is interrupted by the
+// signal fails with EINTR instead of being restarted, so that a program waiting for input notices the signal
+void sigterm_register_interrupting_handler(void)
+{
+    _register(0);
+}
+
+
+
+// the flag that is set when a SIGTERM or SIGINT signal is received
+const atomic_bool* sigterm_flag(void)
+{
+    return &_g_sigterm_received;
+}
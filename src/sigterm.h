@@ -0,0 +1,31 @@
+#ifndef _SIGTERM_H
+#define _SIGTERM_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+
+
+// The executables run until a SIGTERM (or SIGINT) signal is received or the time limit is over, then they
+// output their best solution. The signal handler sets a flag, which is passed to the solver as the flag of
+// its StopCondition (see scheduler.h). This is the only global state, the solver itself does not have any.
+
+
+
+// register the handler that sets the flag returned by sigterm_flag(). Exits on failure.
+void sigterm_register_handler(void);
+
+
+
+// like sigterm_register_handler, but a blocking read (e.g. getline on stdin) that is interrupted by the
+// signal fails with EINTR instead of being restarted, so that a program waiting for input notices the signal
+void sigterm_register_interrupting_handler(void);
+
+
+
+// the flag that is set when a SIGTERM or SIGINT signal is received
+const atomic_bool* sigterm_flag(void);
+
+
+
+#endif
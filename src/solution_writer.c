@@ -0,0 +1,107 @@
+#include "solution_writer.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+
+
+#define SOLUTION_WRITER_MAX_LINE 21 // the decimal digits of UINT64_MAX and the line break
+
+
+
+// "00", "01", ..., "99"
+static const char _g_digit_pairs[201] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                                        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                                        "8081828384858687888990919293949596979899";
+
+
+
+// start writing to fd. Exits on failure.
+void solution_writer_init(SolutionWriter* writer, int fd)
+{
+    writer->fd = fd;
+    writer->buffer = malloc(SOLUTION_WRITER_BUFFER_SIZE);
+    writer->used = 0;
+    writer->failed = false;
+    if(!writer->buffer) {
+        perror("solution_writer_init: allocating buffer failed");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+
+// write the buffer to the file descriptor, and continue after partial writes and interruptions
+static void _flush(SolutionWriter* writer)
+{
+    size_t written = 0;
+    while(!writer->failed && written < writer->used) {
+        const ssize_t result = write(writer->fd, writer->buffer + written, writer->used - written);
+        if(result > 0) {
+            written += (size_t)result;
+        }
+        else if(result == 0 || errno != EINTR) {
+            writer->failed = true;
+        }
+    }
+    writer->used = 0;
+}
+
+
+
+// append the number and a line break
+void solution_writer_add(SolutionWriter* writer, uint64_t number)
+{
+    if(SOLUTION_WRITER_BUFFER_SIZE - writer->used < SOLUTION_WRITER_MAX_LINE) {
+        _flush(writer);
+    }
+    // the digits are produced from the back, two at a time
+    char digits[SOLUTION_WRITER_MAX_LINE];
+    char* p = digits + SOLUTION_WRITER_MAX_LINE;
+    *--p = '\n';
+    while(number >= 100) {
+        const size_t pair = (size_t)(number % 100) * 2;
+        number /= 100;
+        *--p = _g_digit_pairs[pair + 1];
+        *--p = _g_digit_pairs[pair];
+    }
+    if(number >= 10) {
+        *--p = _g_digit_pairs[number * 2 + 1];
+        *--p = _g_digit_pairs[number * 2];
+    }
+    else {
+        *--p = (char)('0' + number);
+    }
+    const size_t length = (size_t)(digits + SOLUTION_WRITER_MAX_LINE - p);
+    memcpy(writer->buffer + writer->used, p, length);
+    writer->used += length;
+}
+
+
+
+// write the rest of the buffer and free it. Does not close the file descriptor.
+// returns false if writing failed (then errno is set)
+bool solution_writer_finish(SolutionWriter* writer)
+{
+    _flush(writer);
+    free(writer->buffer);
+    writer->buffer = NULL;
+    return !writer->failed;
+}
+
+
+
+// write the whole solution with the given vertex ids to fd. returns false if writing failed
+bool solution_write(int fd, const uint32_t* ids, size_t size)
+{
+    SolutionWriter writer;
+    solution_writer_init(&writer, fd);
+    solution_writer_add(&writer, size);
+    for(size_t i = 0; i < size; i++) {
+        solution_writer_add(&writer, ids[i]);
+    }
+    return solution_writer_finish(&writer);
+}
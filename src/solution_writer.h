@@ -0,0 +1,52 @@
+#ifndef _SOLUTION_WRITER_H
+#define _SOLUTION_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+
+// Writes solutions in the PACE output format (the number of vertices, then one vertex id per line) directly
+// to a file descriptor. The numbers are converted two digits at a time into a large buffer, which is written
+// with a few write(2) calls, so even a solution with millions of vertices is written in milliseconds. This
+// matters because the solution is written after SIGTERM, within the grace period.
+// If stdio has been used on the same file descriptor (e.g. stdout), it must be flushed before.
+
+
+
+#define SOLUTION_WRITER_BUFFER_SIZE (1 << 20) // bytes, the buffer is written whenever it is full
+
+
+
+typedef struct SolutionWriter {
+    int fd;
+    char* buffer;
+    size_t used;
+    bool failed; // a write failed, the rest is not written
+} SolutionWriter;
+
+
+
+// start writing to fd. Exits on failure.
+void solution_writer_init(SolutionWriter* writer, int fd);
+
+
+
+// append the number and a line break
+void solution_writer_add(SolutionWriter* writer, uint64_t number);
+
+
+
+// write the rest of the buffer and free it. Does not close the file descriptor.
+// returns false if writing failed (then errno is set)
+bool solution_writer_finish(SolutionWriter* writer);
+
+
+
+// write the whole solution with the given vertex ids to fd. returns false if writing failed
+bool solution_write(int fd, const uint32_t* ids, size_t size);
+
+
+
+#endif
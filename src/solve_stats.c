@@ -0,0 +1,116 @@
+#include "solve_stats.h"
+
+#include <string.h>
+#include <sys/resource.h>
+
+#include "scheduler.h"
+
+
+
+// reset all measurements and set the start to now
+void solve_stats_init(SolveStats* stats)
+{
+    memset(stats, 0, sizeof(SolveStats));
+    stats->start = scheduler_now();
+    stats->engine = "ig";
+    stats->progress_stride = 1;
+}
+
+
+
+// record that the best solution now has ds_size vertices (including the fixed ones), found by source in the
+// given iteration (see TraceEvent). Not thread safe.
+void solve_stats_record_progress(SolveStats* stats, size_t ds_size, uint64_t iteration, const char* source)
+{
+    if(stats->trace != NULL) {
+        trace_record(stats->trace, source, iteration, ds_size);
+    }
+    if(++stats->progress_skipped < stats->progress_stride) {
+        return;
+    }
+    stats->progress_skipped = 0;
+    if(stats->progress_count == SOLVE_STATS_MAX_PROGRESS) { // keep every second point and record half as often
+        for(size_t i = 0; i < SOLVE_STATS_MAX_PROGRESS / 2; i++) {
+            stats->progress[i] = stats->progress[2 * i + 1];
+        }
+        stats->progress_count = SOLVE_STATS_MAX_PROGRESS / 2;
+        stats->progress_stride *= 2;
+    }
+    stats->progress[stats->progress_count++] = (ProgressPoint) {.seconds = scheduler_now() - stats->start,
+                                                                .ds_size = ds_size};
+}
+
+
+
+// the names of the rules in the JSON output
+static const char* const _g_rule_names[REDUCTION_NUM_RULES] = {"redundant", "rule_1", "rule_2"};
+
+
+
+// the time spent on the rule, estimated from its timed attempts
+static double _rule_seconds(const ReductionRuleStats* rule)
+{
+    return rule->timed_attempts > 0 ? rule->timed_seconds * (double)rule->attempts / (double)rule->timed_attempts : 0.0;
+}
+
+
+
+// peak resident set size of the process in kilobytes, 0 if unknown
+static long _peak_rss_kb(void)
+{
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+}
+
+
+
+// write the stats as a JSON object, together with the peak resident set size of the process so far.
+// returns false if writing failed
+bool solve_stats_write_json(const SolveStats* stats, FILE* file)
+{
+    const double search_seconds = stats->search_seconds > 0.0 ? stats->search_seconds : 1.e-9;
+    fprintf(file,
+            "{\n"
+            "  \"input\": {\"n\": %" PRIu32 ", \"m\": %" PRIu64 ", \"incomplete\": %s},\n"
+            "  \"parse_seconds\": %.6f,\n"
+            "  \"reduction_seconds\": %.6f,\n"
+            "  \"kernel\": {\"n\": %" PRIu32 ", \"m\": %" PRIu64 ", \"fixed\": %zu, \"from_cache\": %s, \"complete\": %s},\n"
+            "  \"search\": {\"engine\": \"%s\", \"seconds\": %.6f, \"iterations\": %" PRIu64
+            ", \"iterations_per_second\": %.3f},\n"
+            "  \"ds_size\": %zu,\n",
+            stats->input_n, stats->input_m, stats->is_incomplete ? "true" : "false", stats->parse_seconds,
+            stats->reduction_seconds, stats->kernel_n, stats->kernel_m, stats->fixed_count,
+            stats->kernel_from_cache ? "true" : "false", stats->is_reduction_complete ? "true" : "false",
+            stats->engine, stats->search_seconds, stats->search_iterations,
+            (double)stats->search_iterations / search_seconds, stats->ds_size);
+    fprintf(file, "  \"reduction\": {");
+    for(int rule = 0; rule < REDUCTION_NUM_RULES; rule++) {
+        const ReductionRuleStats* r = &(stats->reduction_rules[rule]);
+        fprintf(file,
+                "%s\"%s\": {\"attempts\": %" PRIu64 ", \"successes\": %" PRIu64 ", \"vertices_removed\": %" PRIu64
+                ", \"seconds\": %.6f}",
+                rule == 0 ? "" : ", ", _g_rule_names[rule], r->attempts, r->successes, r->vertices_removed,
+                _rule_seconds(r));
+    }
+    fprintf(file, "},\n  \"ig_operators\": {");
+    for(int op = 0; op < IG_NUM_OPERATORS; op++) {
+        const IGOperatorCounters* c = &(stats->ig_operators[op]);
+        fprintf(file,
+                "%s\"%s\": {\"iterations\": %" PRIu64 ", \"improvements\": %" PRIu64 ", \"equal_moves\": %" PRIu64
+                ", \"deconstruct_seconds\": %.6f, \"construct_seconds\": %.6f}",
+                op == 0 ? "" : ", ", ig_operator_name((IGOperator)op), c->iterations, c->improvements, c->equal_moves,
+                c->deconstruct_seconds, c->construct_seconds);
+    }
+    fprintf(file,
+            "},\n"
+            "  \"pq_operations\": %" PRIu64 ",\n"
+            "  \"local_search\": {\"phases\": %" PRIu64 ", \"seconds\": %.6f},\n"
+            "  \"peak_rss_kb\": %ld,\n",
+            stats->pq_operations, stats->local_search_phases, stats->local_search_seconds, _peak_rss_kb());
+    fprintf(file, "  \"progress\": [");
+    for(size_t i = 0; i < stats->progress_count; i++) {
+        fprintf(file, "%s[%.6f, %zu]", i == 0 ? "" : ", ", stats->progress[i].seconds, stats->progress[i].ds_size);
+    }
+    fprintf(file, "]\n}\n");
+    return !ferror(file);
+}
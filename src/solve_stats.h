@@ -0,0 +1,82 @@
+#ifndef _SOLVE_STATS_H
+#define _SOLVE_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "reduction.h"
+#include "ig_state.h"
+#include "trace.h"
+
+
+
+// Measurements of one solve, for benchmarks and for understanding where the time goes. Recording them is
+// cheap, so they are always collected (see ds_solver_stats). All times are in seconds, and the points in
+// time are counted from the start of the solve.
+
+
+
+#define SOLVE_STATS_MAX_PROGRESS 1024 // at most x progress points are kept, see solve_stats_record_progress
+
+
+
+// the size of the best solution at some point of the search
+typedef struct ProgressPoint {
+    double seconds;
+    size_t ds_size; // including the fixed vertices
+} ProgressPoint;
+
+
+typedef struct SolveStats {
+    double start; // scheduler_now() at the start of the solve
+    double parse_seconds;     // reading the input, including the hashing if the kernel cache is used
+    double reduction_seconds; // reduction and building the kernel, or loading it from the cache
+    double search_seconds;    // from the end of the reduction to the end of the search
+    uint32_t input_n; // 0 if the kernel was loaded from the cache
+    uint64_t input_m;
+    uint32_t kernel_n;
+    uint64_t kernel_m;
+    size_t fixed_count;
+    bool kernel_from_cache;
+    bool is_reduction_complete; // no rule could be applied anymore, so the kernel does not depend on the budget
+    bool is_incomplete; // the input could not be parsed completely before the stop
+    const char* engine; // "ig" or "cc"
+    uint64_t search_iterations; // iterated greedy iterations of all threads, or cc steps
+    ReductionRuleStats reduction_rules[REDUCTION_NUM_RULES];
+    IGOperatorCounters ig_operators[IG_NUM_OPERATORS]; // summed over the states of all threads
+    uint64_t pq_operations;      // of the greedy constructions of all threads
+    uint64_t local_search_phases;
+    double local_search_seconds; // summed over all threads
+    size_t ds_size; // the result, including the fixed vertices
+    // the improvements of the best solution over time. If there are too many, only every second one is kept,
+    // so that the points are spread over the whole search.
+    ProgressPoint progress[SOLVE_STATS_MAX_PROGRESS];
+    size_t progress_count;
+    size_t progress_stride; // only every progress_stride-th improvement is recorded
+    size_t progress_skipped; // improvements since the last recorded one
+    Trace* trace; // receives every progress point with its details, NULL if no trace is recorded
+} SolveStats;
+
+
+
+// reset all measurements and set the start to now
+void solve_stats_init(SolveStats* stats);
+
+
+
+// record that the best solution now has ds_size vertices (including the fixed ones), found by source in the
+// given iteration (see TraceEvent). Not thread safe.
+void solve_stats_record_progress(SolveStats* stats, size_t ds_size, uint64_t iteration, const char* source);
+
+
+
+// write the stats as a JSON object, together with the peak resident set size of the process so far.
+// returns false if writing failed
+bool solve_stats_write_json(const SolveStats* stats, FILE* file);
+
+
+
+#endif
@@ -0,0 +1,66 @@
+#include "trace.h"
+
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "scheduler.h"
+
+
+
+#define TRACE_INITIAL_CAPACITY 1024
+
+
+
+// start an empty trace at the given time (see scheduler_now)
+void trace_init(Trace* trace, double start)
+{
+    trace->start = start;
+    trace->events = NULL;
+    trace->count = 0;
+    trace->capacity = 0;
+}
+
+
+
+void trace_free(Trace* trace)
+{
+    free(trace->events);
+    trace->events = NULL;
+    trace->count = 0;
+    trace->capacity = 0;
+}
+
+
+
+// add an event at the current time. Not thread safe. Exits on failure.
+void trace_record(Trace* trace, const char* source, uint64_t iteration, size_t ds_size)
+{
+    if(trace->count == trace->capacity) {
+        const size_t capacity = trace->capacity == 0 ? TRACE_INITIAL_CAPACITY : 2 * trace->capacity;
+        TraceEvent* events = realloc(trace->events, capacity * sizeof(TraceEvent));
+        if(!events) {
+            perror("trace_record: realloc failed");
+            exit(EXIT_FAILURE);
+        }
+        trace->events = events;
+        trace->capacity = capacity;
+    }
+    trace->events[trace->count++] = (TraceEvent) {.seconds = scheduler_now() - trace->start,
+                                                  .iteration = iteration,
+                                                  .ds_size = ds_size,
+                                                  .source = source};
+}
+
+
+
+// write the events as tab separated lines "seconds iteration ds_size source" after a header comment.
+// returns false if writing failed
+bool trace_write(const Trace* trace, FILE* file)
+{
+    fprintf(file, "# seconds\titeration\tds_size\tsource\n");
+    for(size_t i = 0; i < trace->count; i++) {
+        const TraceEvent* e = &(trace->events[i]);
+        fprintf(file, "%.6f\t%" PRIu64 "\t%zu\t%s\n", e->seconds, e->iteration, e->ds_size, e->source);
+    }
+    return !ferror(file);
+}
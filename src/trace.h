@@ -0,0 +1,57 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+
+
+// A convergence trace of one solve: the ends of the phases and every improvement of the best solution, with
+// the time, the iteration and what produced it. The events are only collected in memory during the solve,
+// so recording one never waits for I/O, and they are written to a file at the end (see trace_write).
+// The number of events is bounded by the size of the first solution, because every improvement makes the
+// solution smaller.
+
+
+
+typedef struct TraceEvent {
+    double seconds;     // since the start of the solve, monotonic
+    uint64_t iteration; // of the thread that produced the event, 0 for the ends of the phases
+    size_t ds_size;     // of the best solution at that time including the fixed vertices, 0 if there is none yet
+    const char* source; // the phase that ended ("read" with the kernel cache, "parse", "reduction", "initial"),
+                        // or what improved the solution: a deconstruction operator (see ig_operator_name), "local_search", "partition" or "cc"
+} TraceEvent;
+
+
+typedef struct Trace {
+    double start; // scheduler_now() at the start of the solve
+    TraceEvent* events;
+    size_t count;
+    size_t capacity;
+} Trace;
+
+
+
+// start an empty trace at the given time (see scheduler_now)
+void trace_init(Trace* trace, double start);
+
+
+
+void trace_free(Trace* trace);
+
+
+
+// add an event at the current time. Not thread safe. Exits on failure.
+void trace_record(Trace* trace, const char* source, uint64_t iteration, size_t ds_size);
+
+
+
+// write the events as tab separated lines "seconds iteration ds_size source" after a header comment.
+// returns false if writing failed
+bool trace_write(const Trace* trace, FILE* file);
+
+
+
+#endif
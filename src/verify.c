@@ -0,0 +1,362 @@
+#include "verify.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+
+
+#define VERIFY_MIN_BYTES_PER_THREAD (1 << 20) // smaller graphs are checked by fewer threads
+
+
+
+typedef struct VerifyWorker {
+    pthread_t thread;
+    const char* begin; // the edge lines of this worker, starting at the beginning of a line
+    const char* end;
+    uint32_t first_id; // the vertex ids of this worker are first_id, ..., last_id - 1
+    uint32_t last_id;
+    uint32_t n;
+    const bool* in_ds;      // indexed by vertex id
+    atomic_bool* dominated; // indexed by vertex id, shared by all workers
+    uint64_t edge_count;
+    const char* error_line; // the first invalid line in the range of this worker, NULL if there is none
+    uint32_t undominated_count;
+    uint32_t undominated_examples[VERIFY_MAX_EXAMPLES];
+} VerifyWorker;
+
+
+
+// run function for all workers, on the calling thread for the first one
+static void _run_workers(VerifyWorker* workers, unsigned num_workers, void* (*function)(void*))
+{
+    for(unsigned i = 1; i < num_workers; i++) {
+        if(pthread_create(&(workers[i].thread), NULL, function, &(workers[i])) != 0) {
+            perror("verify_solution: pthread_create failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    function(&(workers[0]));
+    for(unsigned i = 1; i < num_workers; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+}
+
+
+
+static inline bool _is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+
+
+// parse the unsigned number at *p after skipping blanks, and move *p behind it.
+// returns false if there is no number, or if it does not fit into 64 bits
+static inline bool _parse_number(const char** p, const char* end, uint64_t* number)
+{
+    const char* s = *p;
+    while(s < end && _is_blank(*s)) {
+        s++;
+    }
+    if(s == end || *s < '0' || *s > '9') {
+        return false;
+    }
+    uint64_t value = 0;
+    for(; s < end && *s >= '0' && *s <= '9'; s++) {
+        if(value > (UINT64_MAX - 9) / 10) {
+            return false;
+        }
+        value = value * 10 + (uint64_t)(*s - '0');
+    }
+    *p = s;
+    *number = value;
+    return true;
+}
+
+
+
+// the beginning of the line after p, or end
+static inline const char* _next_line(const char* p, const char* end)
+{
+    const char* newline = memchr(p, '\n', (size_t)(end - p));
+    return newline != NULL ? newline + 1 : end;
+}
+
+
+
+// for printing a line of the input in an error message
+static int _line_length(const char* line, const char* end)
+{
+    const char* line_end = _next_line(line, end);
+    const size_t length = (size_t)(line_end - line) - (line_end > line && line_end[-1] == '\n');
+    return length < 80 ? (int)length : 80;
+}
+
+
+
+static void* _init_worker_run(void* arg)
+{
+    VerifyWorker* w = arg;
+    for(uint32_t id = w->first_id; id < w->last_id; id++) {
+        atomic_init(&(w->dominated[id]), w->in_ds[id]);
+    }
+    return NULL;
+}
+
+
+
+// parse the edge lines of the worker, and mark the neighbors of ds vertices as dominated
+static void* _edge_worker_run(void* arg)
+{
+    VerifyWorker* w = arg;
+    const char* p = w->begin;
+    while(p < w->end) {
+        const char* line = p;
+        while(p < w->end && _is_blank(*p)) {
+            p++;
+        }
+        if(p == w->end || *p == '\n' || *p == 'c') { // an empty or comment line
+            p = _next_line(p, w->end);
+            continue;
+        }
+        uint64_t u, v;
+        if(!_parse_number(&p, w->end, &u) || !_parse_number(&p, w->end, &v) || u == 0 || u > w->n || v == 0 ||
+           v > w->n) {
+            w->error_line = line;
+            return NULL;
+        }
+        while(p < w->end && _is_blank(*p)) {
+            p++;
+        }
+        if(p < w->end && *p++ != '\n') {
+            w->error_line = line;
+            return NULL;
+        }
+        w->edge_count++;
+        // the relaxed atomic stores are plain stores, they only make the concurrent writes of true well-defined
+        if(w->in_ds[u]) {
+            atomic_store_explicit(&(w->dominated[v]), true, memory_order_relaxed);
+        }
+        if(w->in_ds[v]) {
+            atomic_store_explicit(&(w->dominated[u]), true, memory_order_relaxed);
+        }
+    }
+    return NULL;
+}
+
+
+
+static void* _count_worker_run(void* arg)
+{
+    VerifyWorker* w = arg;
+    for(uint32_t id = w->first_id; id < w->last_id; id++) {
+        if(!atomic_load_explicit(&(w->dominated[id]), memory_order_relaxed)) {
+            if(w->undominated_count < VERIFY_MAX_EXAMPLES) {
+                w->undominated_examples[w->undominated_count] = id;
+            }
+            w->undominated_count++;
+        }
+    }
+    return NULL;
+}
+
+
+
+// parse the problem line "p ds n m" after the leading comments. returns the beginning of the edge lines
+static const char* _parse_header(const char* graph, const char* end, uint32_t* n, uint64_t* m)
+{
+    const char* p = graph;
+    while(p < end && (*p == 'c' || *p == '\n')) {
+        p = _next_line(p, end);
+    }
+    uint64_t tmp_n;
+    if(end - p < 5 || strncmp(p, "p ds ", 5) != 0 || (p += 5, !_parse_number(&p, end, &tmp_n)) ||
+       !_parse_number(&p, end, m) || tmp_n >= UINT32_MAX) {
+        fprintf(stderr, "verify_solution: the graph does not start with a valid line \"p ds n m\"\n");
+        exit(EXIT_FAILURE);
+    }
+    *n = (uint32_t)tmp_n;
+    return _next_line(p, end);
+}
+
+
+
+// check the solution with the given ids and declared size against the graph in the PACE format in
+// graph[0, size), using num_threads threads, and fill report
+void verify_solution(const char* graph, size_t size, const uint32_t* ids, size_t id_count, size_t declared_size,
+                     unsigned num_threads, VerifyReport* report)
+{
+    assert(graph != NULL && (ids != NULL || id_count == 0) && report != NULL);
+    memset(report, 0, sizeof(VerifyReport));
+    const char* end = graph + size;
+    const char* edges = _parse_header(graph, end, &(report->n), &(report->m));
+    const uint32_t n = report->n;
+    report->declared_size = declared_size;
+    report->id_count = id_count;
+
+    bool* in_ds = calloc((size_t)n + 1, sizeof(bool));
+    atomic_bool* dominated = malloc(((size_t)n + 1) * sizeof(atomic_bool));
+    const size_t edge_bytes = (size_t)(end - edges);
+    size_t max_workers = edge_bytes / VERIFY_MIN_BYTES_PER_THREAD;
+    max_workers = max_workers < 1 ? 1 : max_workers;
+    const unsigned num_workers = num_threads < max_workers ? (num_threads > 0 ? num_threads : 1) : (unsigned)max_workers;
+    VerifyWorker* workers = calloc(num_workers, sizeof(VerifyWorker));
+    if(!in_ds || !dominated || !workers) {
+        perror("verify_solution: allocating arrays failed");
+        exit(EXIT_FAILURE);
+    }
+    for(size_t i = 0; i < id_count; i++) {
+        if(ids[i] == 0 || ids[i] > n) {
+            report->unknown_count++;
+        }
+        else if(in_ds[ids[i]]) {
+            report->duplicate_count++;
+        }
+        else {
+            in_ds[ids[i]] = true;
+            report->ds_size++;
+        }
+    }
+
+    // both the edge lines and the vertex ids are split into num_workers ranges of about the same size
+    for(unsigned i = 0; i < num_workers; i++) {
+        VerifyWorker* w = &(workers[i]);
+        w->n = n;
+        w->in_ds = in_ds;
+        w->dominated = dominated;
+        w->first_id = (uint32_t)(1 + (uint64_t)n * i / num_workers);
+        w->last_id = (uint32_t)(1 + (uint64_t)n * (i + 1) / num_workers);
+        const char* begin = edges + edge_bytes / num_workers * i;
+        if(i > 0 && begin[-1] != '\n') {
+            begin = _next_line(begin, end);
+        }
+        w->begin = begin;
+        if(i > 0) {
+            workers[i - 1].end = begin;
+        }
+    }
+    workers[num_workers - 1].end = end;
+
+    _run_workers(workers, num_workers, _init_worker_run);
+    _run_workers(workers, num_workers, _edge_worker_run);
+    uint64_t edge_count = 0;
+    for(unsigned i = 0; i < num_workers; i++) {
+        const char* line = workers[i].error_line;
+        if(line != NULL) {
+            fprintf(stderr, "verify_solution: invalid edge line \"%.*s\"\n", _line_length(line, end), line);
+            exit(EXIT_FAILURE);
+        }
+        edge_count += workers[i].edge_count;
+    }
+    if(edge_count != report->m) {
+        fprintf(stderr, "verify_solution: the graph has %" PRIu64 " edges, but its header declares %" PRIu64 "\n",
+                edge_count, report->m);
+        exit(EXIT_FAILURE);
+    }
+    _run_workers(workers, num_workers, _count_worker_run);
+    for(unsigned i = 0; i < num_workers; i++) {
+        for(uint32_t j = 0; j < workers[i].undominated_count && j < VERIFY_MAX_EXAMPLES; j++) {
+            if(report->undominated_count + j < VERIFY_MAX_EXAMPLES) {
+                report->undominated_examples[report->undominated_count + j] = workers[i].undominated_examples[j];
+            }
+        }
+        report->undominated_count += workers[i].undominated_count;
+    }
+    free(in_ds);
+    free(dominated);
+    free(workers);
+}
+
+
+
+// returns true iff the solution is a dominating set without duplicate or unknown ids, and its declared size
+// matches the number of ids
+bool verify_report_is_valid(const VerifyReport* report)
+{
+    return report->undominated_count == 0 && report->duplicate_count == 0 && report->unknown_count == 0 &&
+           report->declared_size == report->id_count;
+}
+
+
+
+// print the report in a few human readable lines
+void verify_report_print(const VerifyReport* report, FILE* file)
+{
+    fprintf(file, "graph: n == %" PRIu32 ", m == %" PRIu64 "\n", report->n, report->m);
+    fprintf(file, "solution: %zu ids (declared %zu), %zu distinct vertices\n", report->id_count,
+            report->declared_size, report->ds_size);
+    fprintf(file, "duplicate ids: %zu\n", report->duplicate_count);
+    fprintf(file, "unknown ids: %zu\n", report->unknown_count);
+    fprintf(file, "undominated vertices: %" PRIu32, report->undominated_count);
+    for(uint32_t i = 0; i < report->undominated_count && i < VERIFY_MAX_EXAMPLES; i++) {
+        fprintf(file, "%s%" PRIu32, i == 0 ? " (" : " ", report->undominated_examples[i]);
+    }
+    fprintf(file, "%s\n", report->undominated_count == 0                  ? "" :
+                          report->undominated_count <= VERIFY_MAX_EXAMPLES ? ")" :
+                                                                             " ...)");
+    fprintf(file, "%s\n", verify_report_is_valid(report) ? "valid dominating set" : "INVALID");
+}
+
+
+
+// read a solution in the PACE output format from solution[0, size): the number of vertices, then the vertex
+// ids (lines starting with 'c' are comments). Other than graph_parse_solution, this does not stop at invalid
+// ids: ids that do not fit into 32 bits are returned as 0, so that they are reported as unknown.
+// *declared_size is set to the first number, and *id_count to the number of ids after it.
+// caller is responsible for freeing the returned array
+uint32_t* verify_parse_solution(const char* solution, size_t size, size_t* declared_size, size_t* id_count)
+{
+    const char* end = solution + size;
+    const char* p = solution;
+    size_t capacity = 1024;
+    uint32_t* ids = malloc(capacity * sizeof(uint32_t));
+    if(!ids) {
+        perror("verify_parse_solution: allocating ids failed");
+        exit(EXIT_FAILURE);
+    }
+    *id_count = 0;
+    bool has_size = false;
+    while(p < end) {
+        while(p < end && (_is_blank(*p) || *p == '\n')) {
+            p++;
+        }
+        if(p == end) {
+            break;
+        }
+        if(*p == 'c' && (p == solution || p[-1] == '\n')) {
+            p = _next_line(p, end);
+            continue;
+        }
+        uint64_t number;
+        if(!_parse_number(&p, end, &number)) { // not a number, skip the token and count it as an unknown id
+            number = 0;
+            while(p < end && !_is_blank(*p) && *p != '\n') {
+                p++;
+            }
+        }
+        if(!has_size) {
+            *declared_size = (size_t)number;
+            has_size = true;
+            continue;
+        }
+        if(*id_count == capacity) {
+            capacity *= 2;
+            uint32_t* new_ids = realloc(ids, capacity * sizeof(uint32_t));
+            if(!new_ids) {
+                perror("verify_parse_solution: allocating ids failed");
+                exit(EXIT_FAILURE);
+            }
+            ids = new_ids;
+        }
+        ids[(*id_count)++] = number <= UINT32_MAX ? (uint32_t)number : 0;
+    }
+    if(!has_size) {
+        fprintf(stderr, "verify_parse_solution: the solution is empty\n");
+        exit(EXIT_FAILURE);
+    }
+    return ids;
+}
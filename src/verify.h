@@ -0,0 +1,65 @@
+#ifndef _VERIFY_H
+#define _VERIFY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+
+
+// Independent check of a solution against the input graph in the PACE format. The graph is not built: the
+// edge lines are split into one range per thread, and every thread parses its range and marks the
+// neighbors of solution vertices as dominated on the fly. So the check needs only two bytes per vertex and
+// no memory per edge, and scales with the number of threads.
+// A graph that is not in the PACE format is an error like everywhere else: a message is printed and the
+// process exits. Problems of the solution are reported, see VerifyReport.
+
+
+
+#define VERIFY_MAX_EXAMPLES 10 // at most x undominated vertices are listed in the report
+
+
+
+typedef struct VerifyReport {
+    uint32_t n;
+    uint64_t m;
+    size_t declared_size;   // the first number of the solution
+    size_t id_count;        // the number of ids in the solution, including duplicate and unknown ones
+    size_t ds_size;         // the number of distinct valid ids
+    size_t duplicate_count; // ids that occur more than once, counted for every further occurrence
+    size_t unknown_count;   // ids that are 0 or larger than n
+    uint32_t undominated_count;
+    uint32_t undominated_examples[VERIFY_MAX_EXAMPLES]; // the smallest undominated vertices
+} VerifyReport;
+
+
+
+// check the solution with the given ids and declared size against the graph in the PACE format in
+// graph[0, size), using num_threads threads, and fill report
+void verify_solution(const char* graph, size_t size, const uint32_t* ids, size_t id_count, size_t declared_size,
+                     unsigned num_threads, VerifyReport* report);
+
+
+
+// returns true iff the solution is a dominating set without duplicate or unknown ids, and its declared size
+// matches the number of ids
+bool verify_report_is_valid(const VerifyReport* report);
+
+
+
+// print the report in a few human readable lines
+void verify_report_print(const VerifyReport* report, FILE* file);
+
+
+
+// read a solution in the PACE output format from solution[0, size): the number of vertices, then the vertex
+// ids (lines starting with 'c' are comments). Other than graph_parse_solution, this does not stop at invalid
+// ids: ids that do not fit into 32 bits are returned as 0, so that they are reported as unknown.
+// *declared_size is set to the first number, and *id_count to the number of ids after it.
+// caller is responsible for freeing the returned array
+uint32_t* verify_parse_solution(const char* solution, size_t size, size_t* declared_size, size_t* id_count);
+
+
+
+#endif
@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "verify.h"
+#include "cli.h"
+#include "scheduler.h"
+
+
+
+// Checks a solution file against a graph file, independently of the solver (see verify.h). Prints a report
+// and exits with EXIT_SUCCESS iff the solution is a valid dominating set. Both files are memory mapped, so
+// they are never copied, and the edges are checked by all cpus in parallel.
+
+
+
+typedef struct MappedFile {
+    const char* data;
+    size_t size;
+} MappedFile;
+
+
+
+static void _print_usage(FILE* stream, const char* program_name)
+{
+    fprintf(stream,
+            "Usage: %s [--threads K] graph.gr solution.ds\n"
+            "  --threads K         check with K threads (default: the number of online cpus)\n"
+            "  --help              print this help text\n",
+            program_name);
+}
+
+
+
+// map the file at path into memory read only. Exits on failure.
+static MappedFile _map_file(const char* path)
+{
+    const int fd = open(path, O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "verify_solution: opening '%s' failed: ", path);
+        perror(NULL);
+        exit(EXIT_FAILURE);
+    }
+    MappedFile file = {.data = "", .size = (size_t)st.st_size};
+    if(file.size > 0) { // mmap does not accept empty files
+        void* data = mmap(NULL, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED) {
+            fprintf(stderr, "verify_solution: mapping '%s' failed: ", path);
+            perror(NULL);
+            exit(EXIT_FAILURE);
+        }
+        file.data = data;
+    }
+    close(fd);
+    return file;
+}
+
+
+
+static void _unmap_file(MappedFile file)
+{
+    if(file.size > 0) {
+        munmap((void*)(uintptr_t)file.data, file.size);
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned num_threads = cpus > 0 ? (unsigned)cpus : 1;
+    const char* paths[2];
+    int path_count = 0;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_threads = (unsigned)cli_parse_unsigned("--threads", argv[++i], 1, 1024);
+        }
+        else if(strcmp(argv[i], "--help") == 0) {
+            _print_usage(stdout, argv[0]);
+            exit(EXIT_SUCCESS);
+        }
+        else if(argv[i][0] != '-' && path_count < 2) {
+            paths[path_count++] = argv[i];
+        }
+        else {
+            fprintf(stderr, "unknown or incomplete option '%s'\n", argv[i]);
+            _print_usage(stderr, argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if(path_count != 2) {
+        _print_usage(stderr, argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    const double start = scheduler_now();
+    MappedFile graph = _map_file(paths[0]);
+    MappedFile solution = _map_file(paths[1]);
+    size_t declared_size, id_count;
+    uint32_t* ids = verify_parse_solution(solution.data, solution.size, &declared_size, &id_count);
+    _unmap_file(solution);
+    VerifyReport report;
+    verify_solution(graph.data, graph.size, ids, id_count, declared_size, num_threads, &report);
+    _unmap_file(graph);
+    free(ids);
+    verify_report_print(&report, stdout);
+    printf("checked in %.3f s with %u threads\n", scheduler_now() - start, num_threads);
+    return verify_report_is_valid(&report) ? EXIT_SUCCESS : EXIT_FAILURE;
+}